@@ -0,0 +1,182 @@
+//
+// Copyright (C) 2017-2018 Xu Le <xmutongxinXuLe@163.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include <glob.h>
+#include <map>
+#include <mutex>
+#include "Batch.h"
+
+extern int log_level;
+
+void SolverOptions::apply(Solution& solution) const
+{
+	solution.engine = engine;
+	solution.threadNum = threadNum;
+	solution.coarseTopK = coarseTopK;
+	solution.alterDivisions = alterDivisions;
+	solution.verifyAllowed = verifyAllowed;
+	solution.random.seed(seed);
+}
+
+void BatchSummary::add(const DeployStatistic& statistic)
+{
+	if (served.size() < statistic.served.size())
+		served.resize(statistic.served.size());
+	for (size_t k = 0; k < statistic.served.size(); ++k)
+		served[k].push_back(statistic.served[k]);
+	elapses.push_back(1000 * statistic.elapse);
+}
+
+/** write to a temporary file first and rename it, so summary.csv is always complete when streamed. */
+void BatchSummary::write(const char *filename) const
+{
+	std::string tmpFile(filename);
+	tmpFile += ".tmp";
+	FILE *fd = fopen(tmpFile.c_str(), "w");
+	if (fd == NULL)
+	{
+		error_log("Fail to open file %s.\n", tmpFile.c_str());
+		exit(EXIT_FAILURE);
+	}
+
+	fprintf(fd, "k,cases,mean,min,max,p50,p95,p99,stddev\n");
+	char name[16];
+	for (size_t k = 0; k < served.size(); ++k)
+	{
+		snprintf(name, sizeof(name), "%d", static_cast<int>(k+1));
+		_printRow(fd, name, served[k]);
+	}
+	_printRow(fd, "time(ms)", elapses);
+
+	fclose(fd);
+	if (rename(tmpFile.c_str(), filename) != 0)
+	{
+		error_log("Fail to rename %s to %s.\n", tmpFile.c_str(), filename);
+		exit(EXIT_FAILURE);
+	}
+}
+
+void BatchSummary::_printRow(FILE *fd, const char *name, std::vector<double> values)
+{
+	if (values.empty())
+		return;
+	std::sort(values.begin(), values.end());
+	int n = static_cast<int>(values.size());
+	double sum = 0.0, sum2 = 0.0;
+	for (int i = 0; i < n; ++i)
+		sum += values[i];
+	double mean = sum / n;
+	for (int i = 0; i < n; ++i)
+		sum2 += (values[i] - mean) * (values[i] - mean);
+	// nearest rank: the smallest value that is no less than p percent of values
+	double percentile[3] = { 50.0, 95.0, 99.0 }, rank[3];
+	for (int i = 0; i < 3; ++i)
+		rank[i] = values[std::max(static_cast<int>(ceil(percentile[i] / 100 * n)) - 1, 0)];
+	fprintf(fd, "%s,%d,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f\n", name, n, mean, values[0], values[n-1], rank[0], rank[1], rank[2], sqrt(sum2 / n));
+}
+
+void solveCase(const char *caseFile, const SolverOptions& options, const char *uavFile, const char *userFile, const char *statFile, DeployStatistic& statistic)
+{
+	ScenarioContext context;
+	int numAvailableUAV = parseInput(caseFile, context, options.threadNum);
+
+	Solution solution(context);
+	options.apply(solution);
+	solution.deploy(numAvailableUAV, statFile);
+	solution.result(uavFile, userFile);
+	statistic = solution.statistic;
+}
+
+int runBatch(const char *dir, int jobNum, const SolverOptions& options, bool streamSummary)
+{
+	Timer timer("\nrunBatch(): ");
+
+	// each case is solved from case_x.bin if dir has it, otherwise from case_x.txt
+	std::map<std::string, std::string> cases; // "_x." ==> case file
+	const char *extensions[2] = { "txt", "bin" };
+	for (int i = 0; i < 2; ++i)
+	{
+		std::string pattern(dir);
+		pattern += "/case_*.";
+		pattern += extensions[i];
+		glob_t globbed;
+		if (glob(pattern.c_str(), 0, NULL, &globbed) == 0)
+		{
+			for (size_t k = 0; k < globbed.gl_pathc; ++k)
+			{
+				std::string caseFile(globbed.gl_pathv[k]);
+				size_t slash = caseFile.rfind('/') + 1;
+				cases[caseFile.substr(slash + 4, caseFile.size() - slash - 7)] = caseFile;
+			}
+		}
+		globfree(&globbed);
+	}
+	if (cases.empty())
+	{
+		error_log("No case file matches %s/case_*.txt or %s/case_*.bin.\n", dir, dir);
+		exit(EXIT_FAILURE);
+	}
+	// dir/case_x.txt or dir/case_x.bin  ==>  dir/UAVs_x.csv and dir/servedUsers_x.csv, in the order of x
+	int caseNum = static_cast<int>(cases.size());
+	std::vector<std::string> caseFiles(caseNum), uavFiles(caseNum), userFiles(caseNum);
+	std::string prefix(dir);
+	prefix += '/';
+	int k = 0;
+	for (std::map<std::string, std::string>::const_iterator iter = cases.begin(); iter != cases.end(); ++iter, ++k)
+	{
+		caseFiles[k] = iter->second;
+		uavFiles[k] = prefix + "UAVs" + iter->first + "csv";
+		userFiles[k] = prefix + "servedUsers" + iter->first + "csv";
+	}
+
+	std::string statFile(dir);
+	statFile += "/statistic.csv";
+	FILE *fd = fopen(statFile.c_str(), "w");
+	if (fd == NULL)
+	{
+		error_log("Fail to open file %s.\n", statFile.c_str());
+		exit(EXIT_FAILURE);
+	}
+
+	std::string summaryFile(dir);
+	summaryFile += "/summary.csv";
+	BatchSummary summary;
+	std::vector<DeployStatistic> statistics(caseNum);
+	std::vector<bool> done(caseNum, false);
+	int written = 0; // rows of statistics[0, written) are in statistic.csv
+	std::mutex statMutex;
+	parallelFor(caseNum, jobNum, [&](int, int k) {
+		DeployStatistic statistic;
+		solveCase(caseFiles[k].c_str(), options, uavFiles[k].c_str(), userFiles[k].c_str(), NULL, statistic);
+
+		std::lock_guard<std::mutex> lock(statMutex);
+		statistics[k] = statistic;
+		done[k] = true;
+		for (; written < caseNum && done[written]; ++written)
+			statistics[written].print(fd);
+		fflush(fd);
+		summary.add(statistic);
+		if (streamSummary)
+			summary.write(summaryFile.c_str());
+	});
+	fclose(fd);
+	summary.write(summaryFile.c_str());
+
+	uncond_log("\n%d cases are solved, %s and %s are generated\n", caseNum, statFile.c_str(), summaryFile.c_str());
+	return caseNum;
+}
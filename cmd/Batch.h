@@ -0,0 +1,74 @@
+//
+// Copyright (C) 2017-2018 Xu Le <xmutongxinXuLe@163.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#ifndef __BATCH_H__
+#define __BATCH_H__
+
+#include "IFDBSP.h"
+
+/** settings of Solution given on the command line, the same for every case. */
+struct SolverOptions
+{
+	SolverOptions() : engine(Solution::BRUTE_FORCE), threadNum(1), coarseTopK(0), alterDivisions(18), verifyAllowed(false), seed(1) {}
+
+	void apply(Solution& solution) const;
+
+	int engine;
+	int threadNum;
+	int coarseTopK;
+	int alterDivisions;
+	bool verifyAllowed;
+	uint64_t seed;
+};
+
+/**
+ * distributions over cases of the total served users after each UAV and of the time taken by deploy(). Each row
+ * of summary.csv gives the number of cases, mean, min, max, 50th/95th/99th percentiles (nearest rank) and
+ * standard deviation.
+ */
+class BatchSummary
+{
+public:
+	void add(const DeployStatistic& statistic);
+	void write(const char *filename) const;
+	int caseNum() const { return static_cast<int>(elapses.size()); }
+
+private:
+	static void _printRow(FILE *fd, const char *name, std::vector<double> values);
+
+private:
+	std::vector<std::vector<double> > served; ///< served[k] holds the served users of every case after UAV k+1.
+	std::vector<double> elapses; ///< milliseconds taken by deploy() of every case.
+};
+
+/**
+ * solve caseFile, write its UAVs to uavFile and its served users to userFile, and append its statistic to statFile
+ * unless it is NULL. configureUAV() must have been called. Cases share nothing else, so several may run at once.
+ */
+void solveCase(const char *caseFile, const SolverOptions& options, const char *uavFile, const char *userFile, const char *statFile, DeployStatistic& statistic);
+
+/**
+ * solve every case x of dir, from case_x.bin if dir has it and from case_x.txt otherwise, on jobNum threads, each
+ * thread takes the next unsolved case as soon as it is idle.
+ * UAVs_x.csv and servedUsers_x.csv are written to dir, and the rows of dir/statistic.csv are written in case order,
+ * each as soon as the cases before it are done. dir/summary.csv is written at the end, and also after each case
+ * if streamSummary is true. Return the number of cases.
+ */
+int runBatch(const char *dir, int jobNum, const SolverOptions& options, bool streamSummary = false);
+
+#endif /* __BATCH_H__ */
@@ -0,0 +1,67 @@
+//
+// Copyright (C) 2017-2018 Xu Le <xmutongxinXuLe@163.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#ifndef __CASEFILE_H__
+#define __CASEFILE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * binary case file, shared by cmd and gen. The header is followed by numUser user records of CASE_RECORD_SIZE
+ * bytes, each the doubles x, y and z (always 0) laid out as class Point of cmd, then numUser data rates of double,
+ * all in native byte order, so a mapped file is used in place as groundUsers and rateTable. z takes a third of
+ * every record, but dropping it would need a copy into Point on loading, which is what the format avoids.
+ */
+#define CASE_MAGIC          "UAVC"
+#define CASE_VERSION        2
+#define CASE_RECORD_SIZE    24
+
+/** flags of CaseHeader. */
+#define CASE_RATES          0x1   ///< the data rates are given, otherwise they are all 0 as text case files have none.
+
+struct CaseHeader
+{
+	char magic[4];        ///< CASE_MAGIC without the terminating '\0'.
+	uint32_t version;     ///< CASE_VERSION, a file of another version is refused.
+	uint32_t recordSize;  ///< CASE_RECORD_SIZE.
+	int32_t gX;
+	int32_t gY;
+	int32_t numUser;
+	int32_t numAvailableUAV;
+	uint32_t flags;       ///< CASE_RATES or 0.
+	uint64_t checksum;    ///< caseChecksum() of the user records and data rates.
+};
+
+/** FNV-1a hash of size bytes from data, continued from hash. */
+inline uint64_t caseChecksum(const void *data, size_t size, uint64_t hash = 0xCBF29CE484222325ULL)
+{
+	const unsigned char *bytes = static_cast<const unsigned char*>(data);
+	for (size_t i = 0; i < size; ++i)
+		hash = (hash ^ bytes[i]) * 0x100000001B3ULL;
+	return hash;
+}
+
+/** size of a binary case file of numUser users. */
+inline size_t caseFileSize(int numUser)
+{
+	return sizeof(CaseHeader) + static_cast<size_t>(numUser) * (CASE_RECORD_SIZE + sizeof(double));
+}
+
+#endif /* __CASEFILE_H__ */
@@ -20,18 +20,24 @@
 
 extern int log_level;
 
-extern double gX;
-extern double gY;
-extern int numUser;
-extern Point *groundUsers;
-extern double *rateTable;
-extern int *servedTable;
+/** floor() and ceil() of v as int, without the library calls, for the per-row bounds of __rescoreRadius() and __boundUserRows(). */
+static inline int _floorInt(double v)
+{
+	int k = static_cast<int>(v);
+	return k > v ? k - 1 : k;
+}
+
+static inline int _ceilInt(double v)
+{
+	int k = static_cast<int>(v);
+	return k < v ? k + 1 : k;
+}
 
-Solution::Solution() : totalServed(0), oc1(0.9), oc2(0.6), oc3(1.2)
+Solution::Solution(ScenarioContext& _context) : context(_context), engine(BRUTE_FORCE), threadNum(1), alterDivisions(18), verifyAllowed(false), coarseTopK(0), totalServed(0), oc1(0.9), oc2(0.6), oc3(1.2)
 {
 	minRadius = UAV::radiusTable[UAV::minH];
 	maxRadius = UAV::radiusTable[UAV::maxH];
-	int averageDensity = numUser / static_cast<int>(gX/1000*gY/1000);
+	int averageDensity = context.numUser / static_cast<int>(context.gX/1000*context.gY/1000);
 	if (averageDensity >= 400)
 		beginH = UAV::minH;
 	else if (averageDensity <= 100)
@@ -40,55 +46,70 @@ Solution::Solution() : totalServed(0), oc1(0.9), oc2(0.6), oc3(1.2)
 		beginH = UAV::minH + UAV::maxH - averageDensity;
 
 	int leftMargin = static_cast<int>(maxRadius/M_SQRT2) / DETECT * DETECT, downMargin = leftMargin;
-	int rightMargin = static_cast<int>(gX - maxRadius/M_SQRT2) / DETECT * DETECT + DETECT;
-	int upMargin = static_cast<int>(gY - maxRadius/M_SQRT2) / DETECT * DETECT + DETECT;
+	int rightMargin = static_cast<int>(context.gX - maxRadius/M_SQRT2) / DETECT * DETECT + DETECT;
+	int upMargin = static_cast<int>(context.gY - maxRadius/M_SQRT2) / DETECT * DETECT + DETECT;
 	countX = (rightMargin - leftMargin) / DETECT + 1;
 	countY = (upMargin - downMargin) / DETECT + 1;
 	margin = leftMargin;
+	scoreR = -1.0;
+	lazyR = -1.0;
+	arcR = -1.0;
+	lazyRound = lazyEvaluated = lazySkipped = 0;
+	rowSpan = static_cast<int>(2*maxRadius/DETECT) + 3;
+	for (int s = 0; s < ARC_SECTOR; ++s)
+		arcDirs.push_back(Point(cos((2*s + 1)*M_PI/ARC_SECTOR), sin((2*s + 1)*M_PI/ARC_SECTOR)));
+	for (int f = 0; f < ARC_SECTOR*ARC_FINE; ++f)
+		arcDirs.push_back(Point(cos((2*f + 1)*M_PI/(ARC_SECTOR*ARC_FINE)), sin((2*f + 1)*M_PI/(ARC_SECTOR*ARC_FINE))));
 	deployAllowed.resize(countX, std::vector<int>(countY, 1));
+	nearbyCount.resize(countX*countY, 0);
+	bandCover.resize(countX*countY*BAND_SLOT, 0);
+	bandMask.resize(countX*countY, 0);
 	info_log("margin: %f, countX: %d, countY: %d\n", margin, countX, countY);
 	UAVs.reserve(32);
+	uavIndex.initialize(context.gX, context.gY, maxRadius);
 
-	xBucketNum = static_cast<int>(ceil(gX/DETECT));
-	yBucketNum = static_cast<int>(ceil(gY/DETECT));
-	std::vector<std::list<int> > yBuckets(yBucketNum);
-	buckets.resize(xBucketNum, yBuckets);
-	for (int i = 0; i < numUser; ++i)
-	{
-		int _xIdx = static_cast<int>(groundUsers[i].x) / DETECT;
-		int _yIdx = static_cast<int>(groundUsers[i].y) / DETECT;
-		buckets[_xIdx][_yIdx].push_back(i);
-	}
+	xBucketNum = static_cast<int>(ceil(context.gX/DETECT));
+	yBucketNum = static_cast<int>(ceil(context.gY/DETECT));
+	buckets.initialize(xBucketNum, yBucketNum, DETECT, context.groundUsers, context.numUser);
+	selected.resize(context.numUser);
+	unservedSAT.resize(xBucketNum+1, std::vector<int>(yBucketNum+1, 0));
 
 	initialBucketNum = static_cast<int>(ceil((maxRadius + margin)/DETECT));
 	outsideBucketNum = static_cast<int>(ceil((maxRadius - margin)/DETECT));
 	info_log("initialBucketNum: %d, outsideBucketNum: %d\n", initialBucketNum, outsideBucketNum);
 }
 
+void DeployStatistic::print(FILE *fd) const
+{
+	for (size_t k = 0; k < served.size(); ++k)
+		fprintf(fd, "%d,", served[k]);
+	fprintf(fd, "%f\n", elapse);
+}
+
 void Solution::deploy(int K, const char *statfile)
 {
 	Timer timer("\nSolution::deploy(): ");
 
 	numAvailableUAV = K;
 	batch = statfile != NULL ? 1 : 0;
-	std::vector<int> numTotalServiced(K);
+	UAVs.reserve(K); // reallocation would destruct the old UAVs and reset the served table
+	statistic.served.resize(K);
 	for (int k = 0; k < K; ++k)
 	{
 		deployOne();
-		numTotalServiced[k] = totalServed;
+		assert(context.servedTable.count() == totalServed);
+		statistic.served[k] = totalServed;
 	}
+	statistic.elapse = timer.elapsed();
 	if (statfile != NULL)
 	{
-		double elapse = timer.elapsed();
 		FILE *fd = fopen(statfile, "a");
 		if (fd == NULL)
 		{
 			error_log("Fail to open file %s.\n", statfile);
 			exit(EXIT_FAILURE);
 		}
-		for (size_t _k = 0; _k < numTotalServiced.size(); ++_k)
-			fprintf(fd, "%d,", numTotalServiced[_k]);
-		fprintf(fd, "%f\n", elapse);
+		statistic.print(fd);
 		fclose(fd);
 	}
 }
@@ -97,12 +118,14 @@ void Solution::deployOne()
 {
 	uncond_log("\n=========================    deploy UAV %lu    =========================\n", UAVs.size()+1);
 	Timer timer("Solution::deployOne(): ");
+#ifdef COUNT_ALLOCATIONS
+	long allocations = allocationCount;
+#endif
 
-	UAVs.emplace_back(Band::_2_1);
+	UAVs.emplace_back(context, Band::_2_1);
 	UAV &curUAV = UAVs.back();
 
-	double deployProgress = static_cast<double>(UAVs.size()) / numAvailableUAV;
-	int initialH = deployProgress*(UAV::maxH - beginH) + beginH;
+	int initialH = __initialH(UAVs.size());
 	info_log("initialH: %d\n", initialH);
 	curUAV.setH(initialH);
 
@@ -112,12 +135,19 @@ void Solution::deployOne()
 
 	__feedUnserved(UAVs.size()-1);
 
-	curUAV.adjust();
+	curUAV.adjust(random);
 	totalServed += curUAV.userNum();
 	info_log("UAV[%lu]: (%.2f,%.2f), R: %f, N: %d, total served num: %d\n\n", UAVs.size(), curUAV.getX(), curUAV.getY(), curUAV.getR(), curUAV.userNum(), totalServed);
 
-	for (size_t idx = 0; idx < UAVs.size()-1; ++idx)
+	__syncUAVIndex(UAVs.size()-1);
+
+	std::vector<int> nearUAVs;
+	uavIndex.query(curUAV.getPos(), curUAV.getR(), nearUAVs);
+	for (size_t k = 0; k < nearUAVs.size(); ++k)
 	{
+		size_t idx = nearUAVs[k];
+		if (idx == UAVs.size()-1)
+			continue;
 		double distO2O = math::dist(curUAV.getPos(), UAVs[idx].getPos()), distRpR = curUAV.getR() + UAVs[idx].getR();
 		if (distO2O < distRpR)
 		{
@@ -127,6 +157,86 @@ void Solution::deployOne()
 		}
 	}
 
+	__updateDeployAllowed();
+	if (verifyAllowed && !__verifyDeployAllowed())
+	{
+		error_log("assert deployAllowed matches full recomputation failed.\n");
+		exit(EXIT_FAILURE);
+	}
+#ifdef COUNT_ALLOCATIONS
+	uncond_log("allocations: %ld\n", allocationCount - allocations);
+#endif
+}
+
+/**
+ * A lattice point is allowed if fewer than two UAVs are within the nearby distance of it and fewer than bandNum
+ * bands cover it. Every UAV whose position, radius or band differs from its stamp is taken out of the counters
+ * around its stamp and put back around its current disc, so only lattice points near moved UAVs are touched.
+ */
+void Solution::__updateDeployAllowed()
+{
+	for (size_t idx = 0; idx < UAVs.size(); ++idx)
+	{
+		DiscStamp stamp = { UAVs[idx].getPos(), UAVs[idx].getR(), UAVs[idx].getBand() };
+		if (idx == allowedStamps.size())
+			allowedStamps.push_back(stamp);
+		else if (allowedStamps[idx].pos.x != stamp.pos.x || allowedStamps[idx].pos.y != stamp.pos.y || allowedStamps[idx].R != stamp.R || allowedStamps[idx].band != stamp.band)
+		{
+			__applyDiscStamp(allowedStamps[idx], -1);
+			allowedStamps[idx] = stamp;
+		}
+		else
+			continue;
+		__applyDiscStamp(stamp, 1);
+	}
+}
+
+void Solution::__applyDiscStamp(const DiscStamp& stamp, int delta)
+{
+	double nearby = maxRadius/UAV::maxH * beginH, reach = stamp.R + std::max(nearby, 0.0);
+	int iBegin = std::max(static_cast<int>(floor((stamp.pos.x - reach - margin)/DETECT)), 0);
+	int iEnd = std::min(static_cast<int>(ceil((stamp.pos.x + reach - margin)/DETECT)), countX-1);
+	int jBegin = std::max(static_cast<int>(floor((stamp.pos.y - reach - margin)/DETECT)), 0);
+	int jEnd = std::min(static_cast<int>(ceil((stamp.pos.y + reach - margin)/DETECT)), countY-1);
+	int slot = __bandSlot(stamp.band);
+	for (int i = iBegin; i <= iEnd; ++i)
+	{
+		for (int j = jBegin; j <= jEnd; ++j)
+		{
+			Point coord(margin + i*DETECT, margin + j*DETECT);
+			double dist2Circle = math::dist(coord, stamp.pos) - stamp.R;
+			int idx = i*countY + j;
+			if (dist2Circle < 0)
+			{
+				bandCover[idx*BAND_SLOT + slot] += delta;
+				if (bandCover[idx*BAND_SLOT + slot] > 0)
+					bandMask[idx] |= 1 << slot;
+				else
+					bandMask[idx] &= ~(1 << slot);
+			}
+			if (dist2Circle < nearby)
+				nearbyCount[idx] += delta;
+			deployAllowed[i][j] = nearbyCount[idx] < 2 && static_cast<size_t>(__builtin_popcount(bandMask[idx])) < UAV::bandNum ? 1 : 0;
+		}
+	}
+	if (arcR > 0.0) // centers of the arc sweep scan take the mask of their nearest lattice point
+		__markArcDirty(stamp.pos, reach + DETECT);
+}
+
+int Solution::__bandSlot(int band)
+{
+	int slot = static_cast<int>(std::find(bandSlots.begin(), bandSlots.end(), band) - bandSlots.begin());
+	if (slot == static_cast<int>(bandSlots.size()))
+	{
+		assert(slot < BAND_SLOT);
+		bandSlots.push_back(band);
+	}
+	return slot;
+}
+
+/** recompute the deployment mask from all UAVs and compare it with the incrementally maintained one. */
+bool Solution::__verifyDeployAllowed()
+{
 	std::set<int> bandSet;
 	for (int i = 0; i < countX; ++i)
 	{
@@ -143,13 +253,89 @@ void Solution::deployOne()
 				if (dist2Circle < maxRadius/UAV::maxH * beginH)
 					++numNearbyUAV;
 			}
-			deployAllowed[i][j] = numNearbyUAV < 2 && bandSet.size() < UAV::bandNum ? 1 : 0;
+			int allowed = numNearbyUAV < 2 && bandSet.size() < UAV::bandNum ? 1 : 0;
+			if (deployAllowed[i][j] != allowed)
+			{
+				error_log("deployAllowed[%d][%d] is %d, but %d is expected.\n", i, j, deployAllowed[i][j], allowed);
+				return false;
+			}
 		}
 	}
+	return true;
+}
+
+/** visit every lattice point (i,j) within distance R of U, the distance is measured as in the brute force scan. */
+template <class _Visitor>
+void Solution::__visitLatticeNear(const Point& U, double R, _Visitor visit)
+{
+	int iBegin = std::max(static_cast<int>(floor((U.x - R - margin)/DETECT)), 0);
+	int iEnd = std::min(static_cast<int>(ceil((U.x + R - margin)/DETECT)), countX-1);
+	int jBegin = std::max(static_cast<int>(floor((U.y - R - margin)/DETECT)), 0);
+	int jEnd = std::min(static_cast<int>(ceil((U.y + R - margin)/DETECT)), countY-1);
+	for (int i = iBegin; i <= iEnd; ++i)
+		for (int j = jBegin; j <= jEnd; ++j)
+			if (math::dist(U, Point(margin + i*DETECT, margin + j*DETECT)) < R)
+				visit(i, j);
+}
+
+/**
+ * extend the range [jBegin, jEnd) of the lattice points of row i within distance r of U to a larger r, and visit the
+ * lattice points it gains. An empty range is kept at the lattice point of the row nearest to U, where it starts
+ * to grow. The distance is measured as in the brute force scan.
+ */
+template <class _Visitor>
+void Solution::__growRowRange(const Point& U, int i, double r, int& jBegin, int& jEnd, _Visitor visit)
+{
+	if (jBegin == jEnd)
+	{
+		// the lattice point nearest to U is jBegin or the next one
+		if (__latticeWithin(U, i, jBegin, r))
+			++jEnd;
+		else if (jBegin + 1 < countY && __latticeWithin(U, i, jBegin + 1, r))
+			jEnd = ++jBegin + 1;
+		else
+			return;
+		visit(i, jBegin);
+	}
+	while (jBegin > 0 && __latticeWithin(U, i, jBegin - 1, r))
+		visit(i, --jBegin);
+	while (jEnd < countY && __latticeWithin(U, i, jEnd, r))
+		visit(i, jEnd++);
+}
+
+/** whether lattice point (i,j) is within distance r of U, exactly as math::dist() tells, but mostly without its sqrt(). */
+bool Solution::__latticeWithin(const Point& U, int i, int j, double r)
+{
+	double dx = margin + i*DETECT - U.x, dy = margin + j*DETECT - U.y, d2 = dx*dx + dy*dy, r2 = r*r;
+	if (d2 > r2*(1 + 1e-9)) // precision consideration, only distances this close to r are taken exactly
+		return false;
+	if (d2 < r2*(1 - 1e-9))
+		return true;
+	return math::dist(U, Point(margin + i*DETECT, margin + j*DETECT)) < r;
 }
 
 int Solution::__findMaxCanServePlace(double &maxX, double &maxY, double R)
 {
+	if (engine == SUMMED_AREA)
+		return __summedAreaScan(maxX, maxY, R);
+	if (engine == INCREMENTAL)
+		return __incrementalScan(maxX, maxY, R);
+	if (engine == LAZY_GREEDY)
+		return __lazyGreedyScan(maxX, maxY, R);
+	if (engine == TILED)
+		return __tiledScan(maxX, maxY, R);
+	if (engine == COARSE_FINE)
+		return __coarseFineScan(maxX, maxY, R);
+	if (engine == ARC_SWEEP)
+	{
+		int coveredNum = __arcSweepScan(maxX, maxY, R);
+		if (coveredNum >= 0)
+			return coveredNum;
+		info_log("arc sweep scan finds no allowed center, fall back to lattice.\n");
+	}
+	if (threadNum > 1)
+		return __parallelScan(maxX, maxY, R);
+
 	int maxUnservedNearby = -1;
 	int xBegin = 0, xEnd = initialBucketNum;
 	for (int i = 0; i < countX; ++i)
@@ -162,10 +348,10 @@ int Solution::__findMaxCanServePlace(double &maxX, double &maxY, double R)
 				Point coord(margin + i*DETECT, margin + j*DETECT);
 				int unservedNearby = 0;
 				for (int m = xBegin; m < xEnd; ++m)
-					for (int n = yBegin; n < yEnd; ++n)
-						for (itUS = buckets[m][n].begin(); itUS != buckets[m][n].end(); ++itUS)
-							if (math::dist(groundUsers[*itUS], coord) < R)
-								++unservedNearby;
+				{
+					int sBegin = buckets.stripBegin(m, yBegin), sEnd = buckets.stripEnd(m, yEnd);
+					unservedNearby += kernel::countInDisc(buckets.x.data() + sBegin, buckets.y.data() + sBegin, sEnd - sBegin, coord, R);
+				}
 				if (maxUnservedNearby < unservedNearby)
 				{
 					maxUnservedNearby = unservedNearby;
@@ -186,6 +372,807 @@ int Solution::__findMaxCanServePlace(double &maxX, double &maxY, double R)
 	return maxUnservedNearby;
 }
 
+/**
+ * Same placement as the brute force scan. Rows of the lattice are handed out to threadNum threads, each thread
+ * keeps the first best lattice point of its rows, and the best of them with the smallest lattice index wins.
+ */
+int Solution::__parallelScan(double &maxX, double &maxY, double R)
+{
+	std::vector<std::pair<int, int> > threadBest(threadNum, std::pair<int, int>(-1, -1)); // pair of count and lattice index
+	pool.run(countX, threadNum, [this, R, &threadBest](int t, int i) {
+		std::pair<int, int> best = threadBest[t];
+		for (int j = 0; j < countY; ++j)
+		{
+			if (deployAllowed[i][j] == 1)
+			{
+				int unservedNearby = __countUnservedNearby(Point(margin + i*DETECT, margin + j*DETECT), R);
+				if (best.first < unservedNearby)
+					best = std::pair<int, int>(unservedNearby, i*countY + j);
+			}
+		}
+		threadBest[t] = best;
+	});
+
+	int maxUnservedNearby = -1, maxIdx = -1;
+	for (int t = 0; t < threadNum; ++t)
+	{
+		if (maxUnservedNearby < threadBest[t].first || (maxUnservedNearby == threadBest[t].first && threadBest[t].second < maxIdx))
+		{
+			maxUnservedNearby = threadBest[t].first;
+			maxIdx = threadBest[t].second;
+		}
+	}
+	if (maxIdx >= 0)
+		maxX = margin + maxIdx/countY*DETECT, maxY = margin + maxIdx%countY*DETECT;
+	return maxUnservedNearby;
+}
+
+/**
+ * Same placement as the brute force scan. Lattice points are grouped in tiles of TILE x TILE, and each column
+ * strip of cells around a tile is read once and counted against every allowed lattice point of the tile whose
+ * own window contains that column, while the points of the strip stay in registers. Tile rows are handed out
+ * to threadNum threads.
+ */
+int Solution::__tiledScan(double &maxX, double &maxY, double R)
+{
+	int tileRowNum = (countX + TILE - 1) / TILE;
+	std::vector<std::pair<int, int> > threadBest(threadNum, std::pair<int, int>(-1, -1)); // pair of count and lattice index
+	pool.run(tileRowNum, threadNum, [this, R, &threadBest](int t, int ti) {
+		std::pair<int, int> best = threadBest[t];
+		int iBegin = ti*TILE, iEnd = std::min(iBegin + TILE, countX);
+		Point centers[TILE*TILE];
+		int lattice[TILE*TILE], counts[TILE*TILE];
+		for (int jBegin = 0; jBegin < countY; jBegin += TILE)
+		{
+			int jEnd = std::min(jBegin + TILE, countY);
+			int centerNum = 0, firstCenter[TILE+1]; // centers of row iBegin + l are [firstCenter[l], firstCenter[l+1])
+			for (int i = iBegin; i < iEnd; ++i)
+			{
+				firstCenter[i - iBegin] = centerNum;
+				for (int j = jBegin; j < jEnd; ++j)
+				{
+					if (deployAllowed[i][j] == 1)
+					{
+						centers[centerNum] = Point(margin + i*DETECT, margin + j*DETECT);
+						lattice[centerNum++] = i*countY + j;
+					}
+				}
+			}
+			firstCenter[iEnd - iBegin] = centerNum;
+			if (centerNum == 0)
+				continue;
+
+			// the window of lattice point (i,j) spans cells [i - outsideBucketNum, i + initialBucketNum) x [j - outsideBucketNum, j + initialBucketNum)
+			std::fill(counts, counts + centerNum, 0);
+			int xBegin = std::max(iBegin - outsideBucketNum, 0), xEnd = std::min(iEnd - 1 + initialBucketNum, xBucketNum);
+			int yBegin = std::max(jBegin - outsideBucketNum, 0), yEnd = std::min(jEnd - 1 + initialBucketNum, yBucketNum);
+			for (int m = xBegin; m < xEnd; ++m)
+			{
+				int lBegin = std::max(m - initialBucketNum + 1, iBegin) - iBegin, lEnd = std::min(m + outsideBucketNum + 1, iEnd) - iBegin;
+				if (lBegin >= lEnd || firstCenter[lBegin] == firstCenter[lEnd])
+					continue;
+				int sBegin = buckets.stripBegin(m, yBegin), sEnd = buckets.stripEnd(m, yEnd);
+				kernel::countInDiscs(buckets.x.data() + sBegin, buckets.y.data() + sBegin, sEnd - sBegin, centers + firstCenter[lBegin],
+						firstCenter[lEnd] - firstCenter[lBegin], R, counts + firstCenter[lBegin]);
+			}
+			for (int c = 0; c < centerNum; ++c)
+				if (best.first < counts[c] || (best.first == counts[c] && lattice[c] < best.second))
+					best = std::pair<int, int>(counts[c], lattice[c]);
+		}
+		threadBest[t] = best;
+	});
+
+	int maxUnservedNearby = -1, maxIdx = -1;
+	for (int t = 0; t < threadNum; ++t)
+	{
+		if (maxUnservedNearby < threadBest[t].first || (maxUnservedNearby == threadBest[t].first && threadBest[t].second < maxIdx))
+		{
+			maxUnservedNearby = threadBest[t].first;
+			maxIdx = threadBest[t].second;
+		}
+	}
+	if (maxIdx >= 0)
+		maxX = margin + maxIdx/countY*DETECT, maxY = margin + maxIdx%countY*DETECT;
+	return maxUnservedNearby;
+}
+
+/**
+ * Disc centers are not restricted to the lattice. For every unserved user P, centers of discs of radius R with P on
+ * the boundary form a circle around P, and each unserved user Q within 2R of P is covered on an arc of that circle.
+ * Sweeping the arc endpoints by angle finds the center covering the most users around P. Centers are allowed if
+ * their nearest lattice point is. Ties are broken by the smaller user ID of P, then by the smaller angle.
+ * The best center of each P is kept in arcCovered and arcAngle until users or lattice points change within reach
+ * of it, see __staleArcCache(). The other users are swept in descending order of __arcUpperBound() on threadNum
+ * threads, each thread skips the users whose bound cannot beat its best and sweeps only the arcs reaching the hot
+ * arcs of the others. The sweeps of dense maps still take seconds per UAV, the engine is meant for comparisons.
+ */
+int Solution::__arcSweepScan(double &maxX, double &maxY, double R)
+{
+	struct ArcBest {
+		int covered;
+		int user;
+		double angle;
+	};
+	struct ArcScratch {
+		std::vector<int> selected;
+		std::vector<std::pair<double, int> > events; ///< pair of angle and 0 for entering an arc, 1 for leaving it.
+		std::vector<int> sectors; ///< difference of arcs entering and leaving each of ARC_SECTOR*ARC_FINE sectors of the circle.
+		std::vector<int> hot; ///< fine arcs whose bound reaches need, see __arcUpperBound().
+		std::vector<int> hotPrefix; ///< hot arcs before each fine arc.
+	};
+	const double sweepR = R - 1e-6; // precision consideration, covered users stay strictly within R
+	__staleArcCache(R);
+	__buildUnservedSAT();
+	__buildArcFineSAT();
+
+	ArcBest cached{ -1, -1, 0.0 };
+	int cachedNum = 0;
+	arcOrder.clear();
+	for (int m = 0; m < xBucketNum; ++m)
+	{
+		for (int n = 0; n < yBucketNum; ++n)
+		{
+			for (int sp = buckets.begin(m, n); sp < buckets.end(m, n); ++sp)
+			{
+				int user = buckets.id[sp];
+				if (arcCovered[user] == -2)
+					arcOrder.push_back(std::pair<int, int>(-__arcUpperBound(Point(buckets.x[sp], buckets.y[sp]), sweepR, context.numUser + 1, NULL), sp)); // coarse only
+				else
+				{
+					++cachedNum;
+					if (cached.covered < arcCovered[user] || (cached.covered == arcCovered[user] && user < cached.user))
+						cached = ArcBest{ arcCovered[user], user, arcAngle[user] };
+				}
+			}
+		}
+	}
+	std::sort(arcOrder.begin(), arcOrder.end());
+	info_log("arc sweep scan: %d users are cached, %lu are swept at most.\n", cachedNum, arcOrder.size());
+
+	int reach = static_cast<int>(ceil(2*sweepR/DETECT));
+	std::vector<ArcBest> threadBest(threadNum, cached);
+	std::vector<ArcScratch> scratch(threadNum);
+	pool.run(static_cast<int>(arcOrder.size()), threadNum, [this, sweepR, reach, &threadBest, &scratch](int t, int k) {
+		ArcBest &best = threadBest[t];
+		int sp = arcOrder[k].second, user = buckets.id[sp];
+		int need = user < best.user ? best.covered : best.covered + 1; // covered users P must reach to beat best
+		if (-arcOrder[k].first < need)
+			return;
+		Point P(buckets.x[sp], buckets.y[sp]);
+		std::vector<int> &hot = scratch[t].hot;
+		if (__arcUpperBound(P, sweepR, need, &hot) < need) // stays stale
+			return;
+
+		// only the arcs of users reaching a hot arc, or one next to it, are swept, the other centers cover fewer than need
+		const int sectorNum = ARC_SECTOR*ARC_FINE;
+		std::vector<int> &hotPrefix = scratch[t].hotPrefix, &selected = scratch[t].selected, &sectors = scratch[t].sectors;
+		hotPrefix.assign(sectorNum + 2, 0);
+		const double fineR = sweepR*(1 + sin(M_PI/sectorNum)) + 1e-6; // precision consideration
+		double boxLeft = P.x + 2*sweepR, boxRight = P.x - 2*sweepR, boxDown = P.y + 2*sweepR, boxUp = P.y - 2*sweepR;
+		for (size_t h = 0; h < hot.size(); ++h)
+		{
+			hotPrefix[hot[h] + 1] = 1;
+			const Point &dir = arcDirs[ARC_SECTOR + hot[h]];
+			boxLeft = std::min(boxLeft, P.x + sweepR*dir.x - fineR), boxRight = std::max(boxRight, P.x + sweepR*dir.x + fineR);
+			boxDown = std::min(boxDown, P.y + sweepR*dir.y - fineR), boxUp = std::max(boxUp, P.y + sweepR*dir.y + fineR);
+		}
+		for (int s = 0; s <= sectorNum; ++s)
+			hotPrefix[s+1] += hotPrefix[s];
+		std::vector<std::pair<double, int> > &events = scratch[t].events;
+		events.clear();
+		sectors.assign(sectorNum + 1, 0);
+		int covered = 1; // P itself and the arcs covering angle 0
+		int mp = static_cast<int>(P.x/DETECT), np = static_cast<int>(P.y/DETECT);
+		int mBegin = std::max(std::max(mp - reach, static_cast<int>(floor(boxLeft/DETECT))), 0);
+		int mEnd = std::min(std::min(mp + reach, static_cast<int>(floor(boxRight/DETECT))) + 1, xBucketNum);
+		int nBegin = std::max(std::max(np - reach, static_cast<int>(floor(boxDown/DETECT))), 0);
+		int nEnd = std::min(std::min(np + reach, static_cast<int>(floor(boxUp/DETECT))) + 1, yBucketNum);
+		for (int m = mBegin; m < mEnd && nBegin < nEnd; ++m)
+		{
+			int sBegin = buckets.stripBegin(m, nBegin), sEnd = buckets.stripEnd(m, nEnd);
+			if (static_cast<int>(selected.size()) < sEnd - sBegin)
+				selected.resize(sEnd - sBegin);
+			int selectedNum = kernel::selectInDisc(buckets.x.data() + sBegin, buckets.y.data() + sBegin, sEnd - sBegin, P, 2*sweepR, selected.data());
+			for (int i = 0; i < selectedNum; ++i)
+			{
+				int slot = sBegin + selected[i];
+				if (slot == sp || buckets.x[slot] < boxLeft || buckets.x[slot] > boxRight || buckets.y[slot] < boxDown || buckets.y[slot] > boxUp)
+					continue; // not within fineR of any hot arc
+				double dx = buckets.x[slot] - P.x, dy = buckets.y[slot] - P.y;
+				double alpha = acos(std::min(sqrt(dx*dx + dy*dy)/(2*sweepR), 1.0));
+				double enter = atan2(dy, dx) - alpha;
+				if (enter < 0.0)
+					enter += 2*M_PI;
+				double leave = enter + 2*alpha;
+				bool wrapped = leave >= 2*M_PI;
+				if (wrapped)
+					leave -= 2*M_PI;
+				int sEnter = std::min(static_cast<int>(enter*(sectorNum/(2*M_PI))), sectorNum-1);
+				int sLeave = std::min(static_cast<int>(leave*(sectorNum/(2*M_PI))), sectorNum-1);
+				// hot arcs in the cyclic range [lo, hi] of fine arcs
+				int lo = sEnter - 1, hi = sLeave + 1 + (wrapped ? sectorNum : 0);
+				if (lo < 0)
+					lo += sectorNum, hi += sectorNum;
+				if (hi - lo + 1 < sectorNum && (hi < sectorNum ? hotPrefix[hi+1] - hotPrefix[lo] : hotPrefix[sectorNum] - hotPrefix[lo] + hotPrefix[hi-sectorNum+1]) == 0)
+					continue;
+				if (wrapped)
+				{
+					++covered;
+					++sectors[0]; // the arc wraps around, it leaves a sector after it enters one
+				}
+				++sectors[sEnter], --sectors[sLeave + 1];
+				events.push_back(std::pair<double, int>(enter, 0));
+				events.push_back(std::pair<double, int>(leave, 1));
+			}
+		}
+
+		// arcs reaching each sector bound the users covered by the centers in it
+		int sectorBound = 0;
+		for (int s = 0, reaching = 1; s < sectorNum; ++s)
+			reaching += sectors[s], sectorBound = std::max(sectorBound, reaching);
+		if (sectorBound < need) // stays stale
+			return;
+		std::sort(events.begin(), events.end());
+
+		// windows reaching need lie within the hot arcs, so their counts and the first of the best are exact
+		ArcBest local{ need - 1, user, 0.0 };
+		double from = 0.0;
+		for (size_t i = 0; i <= events.size(); ++i)
+		{
+			double to = i < events.size() ? events[i].first : 2*M_PI;
+			if (to > from && local.covered < covered)
+			{
+				double angle = (from + to) / 2;
+				if (__deployAllowedAt(Point(P.x + sweepR*cos(angle), P.y + sweepR*sin(angle))))
+					local.covered = covered, local.angle = angle;
+			}
+			if (i < events.size())
+			{
+				covered += events[i].second == 0 ? 1 : -1;
+				from = to;
+			}
+		}
+		if (local.covered < need) // stays stale
+			return;
+		arcCovered[user] = local.covered;
+		arcAngle[user] = local.angle;
+		best = local;
+	});
+
+	ArcBest best{ -1, -1, 0.0 };
+	for (int t = 0; t < threadNum; ++t)
+		if (best.covered < threadBest[t].covered || (best.covered == threadBest[t].covered && threadBest[t].user < best.user))
+			best = threadBest[t];
+	if (best.covered >= 0)
+	{
+		maxX = context.groundUsers[best.user].x + sweepR*cos(best.angle);
+		maxY = context.groundUsers[best.user].y + sweepR*sin(best.angle);
+		info_log("arc sweep scan: covered %d, position: (%.2f, %.2f)\n", best.covered, maxX, maxY);
+	}
+	return best.covered;
+}
+
+/**
+ * upper bound of unserved users a disc of radius R with P on its boundary can cover. The circle of centers is cut
+ * into ARC_SECTOR arcs, discs centered on an arc lie in the disc around its midpoint widened by half its chord, and
+ * all of them lie within 2R of P. Arcs whose bound reaches need are cut into ARC_FINE arcs again, bounded by the
+ * users in cells ARC_FINE times smaller from arcFineSAT, so the bound is tight only where it may reach need. The
+ * fine arcs whose bound reaches need are returned in hot if it is not NULL.
+ */
+int Solution::__arcUpperBound(const Point& P, double R, int need, std::vector<int> *hot)
+{
+	const int fineNum = ARC_SECTOR*ARC_FINE;
+	double halfChord = R*sin(M_PI/ARC_SECTOR) + 1e-6, fineHalfChord = R*sin(M_PI/fineNum) + 1e-6; // precision consideration
+	int upperBound = 0;
+	if (hot != NULL)
+		hot->clear();
+	for (int s = 0; s < ARC_SECTOR; ++s)
+	{
+		const Point &dir = arcDirs[s];
+		int sectorBound = __discUpperBound(Point(P.x + R*dir.x, P.y + R*dir.y), R + halfChord);
+		if (sectorBound >= need)
+		{
+			int fineBound = 0;
+			for (int f = s*ARC_FINE; f < (s+1)*ARC_FINE; ++f)
+			{
+				const Point &fineDir = arcDirs[ARC_SECTOR + f];
+				int bound = __fineDiscUpperBound(Point(P.x + R*fineDir.x, P.y + R*fineDir.y), R + fineHalfChord);
+				if (hot != NULL && bound >= need)
+					hot->push_back(f);
+				fineBound = std::max(fineBound, bound);
+			}
+			sectorBound = std::min(sectorBound, fineBound);
+		}
+		upperBound = std::max(upperBound, sectorBound);
+	}
+	return std::min(upperBound, __discUpperBound(P, 2*R));
+}
+
+/** __discUpperBound() over the cells of arcFineSAT. */
+int Solution::__fineDiscUpperBound(const Point& coord, double R)
+{
+	const double cell = static_cast<double>(DETECT)/ARC_FINE;
+	int xNum = xBucketNum*ARC_FINE, yNum = yBucketNum*ARC_FINE, upperBound = 0;
+	int nBegin = std::max(static_cast<int>(floor((coord.y - R)/cell)), 0);
+	int nEnd = std::min(static_cast<int>(floor((coord.y + R)/cell)), yNum-1);
+	for (int n = nBegin; n <= nEnd; ++n)
+	{
+		double dy = 0.0;
+		if (coord.y < n*cell)
+			dy = n*cell - coord.y;
+		else if (coord.y > (n+1)*cell)
+			dy = coord.y - (n+1)*cell;
+		if (dy >= R)
+			continue;
+		double halfWidth = sqrt(R*R - dy*dy) + 1e-6; // precision consideration
+		int mBegin = std::max(static_cast<int>(floor((coord.x - halfWidth)/cell)), 0);
+		int mEnd = std::min(static_cast<int>(floor((coord.x + halfWidth)/cell)), xNum-1);
+		if (mBegin <= mEnd)
+			upperBound += arcFineSAT[(mEnd+1)*(yNum+1) + n+1] - arcFineSAT[mBegin*(yNum+1) + n+1] - arcFineSAT[(mEnd+1)*(yNum+1) + n] + arcFineSAT[mBegin*(yNum+1) + n];
+	}
+	return upperBound;
+}
+
+/** summed-area table of unserved users in cells of DETECT/ARC_FINE, arcFineSAT[m*(yNum+1) + n] sums cells [0..m-1][0..n-1]. */
+void Solution::__buildArcFineSAT()
+{
+	const double cell = static_cast<double>(DETECT)/ARC_FINE;
+	int xNum = xBucketNum*ARC_FINE, yNum = yBucketNum*ARC_FINE;
+	arcFineSAT.assign((xNum+1)*(yNum+1), 0);
+	for (int m = 0; m < xBucketNum; ++m)
+	{
+		for (int n = 0; n < yBucketNum; ++n)
+		{
+			for (int sp = buckets.begin(m, n); sp < buckets.end(m, n); ++sp)
+			{
+				int fm = std::min(static_cast<int>(buckets.x[sp]/cell), xNum-1), fn = std::min(static_cast<int>(buckets.y[sp]/cell), yNum-1);
+				++arcFineSAT[(fm+1)*(yNum+1) + fn+1];
+			}
+		}
+	}
+	for (int m = 1; m <= xNum; ++m)
+		for (int n = 1; n <= yNum; ++n)
+			arcFineSAT[m*(yNum+1) + n] += arcFineSAT[(m-1)*(yNum+1) + n] + arcFineSAT[m*(yNum+1) + n-1] - arcFineSAT[(m-1)*(yNum+1) + n-1];
+}
+
+/**
+ * mark the cached best centers of the arc sweep scan stale. All of them are stale when R differs from arcR, else
+ * those of users within 2R plus a cell of a cell marked in arcDirty, as their neighbours or the lattice points
+ * around their circles of centers may have changed.
+ */
+void Solution::__staleArcCache(double R)
+{
+	if (arcR != R)
+	{
+		arcR = R;
+		arcCovered.assign(context.numUser, -2);
+		arcAngle.resize(context.numUser);
+		arcDirty.assign(xBucketNum*yBucketNum, 0);
+		return;
+	}
+	std::vector<std::vector<int> > &dirtySAT = unservedSAT; // rebuilt from the buckets by the caller afterwards
+	for (int m = 0; m < xBucketNum; ++m)
+		for (int n = 0; n < yBucketNum; ++n)
+			dirtySAT[m+1][n+1] = arcDirty[m*yBucketNum + n] + dirtySAT[m][n+1] + dirtySAT[m+1][n] - dirtySAT[m][n];
+	int reach = static_cast<int>(ceil(2*R/DETECT)) + 1;
+	for (int m = 0; m < xBucketNum; ++m)
+	{
+		int mBegin = std::max(m - reach, 0), mEnd = std::min(m + reach + 1, xBucketNum);
+		for (int n = 0; n < yBucketNum; ++n)
+		{
+			int nBegin = std::max(n - reach, 0), nEnd = std::min(n + reach + 1, yBucketNum);
+			if (dirtySAT[mEnd][nEnd] - dirtySAT[mBegin][nEnd] - dirtySAT[mEnd][nBegin] + dirtySAT[mBegin][nBegin] == 0)
+				continue;
+			for (int sp = buckets.begin(m, n); sp < buckets.end(m, n); ++sp)
+				arcCovered[buckets.id[sp]] = -2;
+		}
+	}
+	std::fill(arcDirty.begin(), arcDirty.end(), 0);
+}
+
+/** mark the cells within r of coord in arcDirty, see __staleArcCache(). */
+void Solution::__markArcDirty(const Point& coord, double r)
+{
+	int mBegin = std::max(static_cast<int>(floor((coord.x - r)/DETECT)), 0);
+	int mEnd = std::min(static_cast<int>(floor((coord.x + r)/DETECT)), xBucketNum-1);
+	int nBegin = std::max(static_cast<int>(floor((coord.y - r)/DETECT)), 0);
+	int nEnd = std::min(static_cast<int>(floor((coord.y + r)/DETECT)), yBucketNum-1);
+	for (int m = mBegin; m <= mEnd; ++m)
+		for (int n = nBegin; n <= nEnd; ++n)
+			arcDirty[m*yBucketNum + n] = 1;
+}
+
+bool Solution::__deployAllowedAt(const Point& coord)
+{
+	int i = static_cast<int>(floor((coord.x - margin)/DETECT + 0.5)), j = static_cast<int>(floor((coord.y - margin)/DETECT + 0.5));
+	return i >= 0 && i < countX && j >= 0 && j < countY && deployAllowed[i][j] == 1;
+}
+
+/**
+ * Same placement as the brute force scan. Every allowed lattice point is bounded from above by the number of
+ * unserved users in the buckets its disc intersects, which is read from the summed-area table row by row.
+ * Lattice points are visited in descending order of their bounds, so the scan stops as soon as no remaining
+ * bound can beat the best exact count, ties are broken by the lattice index as in the brute force scan.
+ */
+int Solution::__summedAreaScan(double &maxX, double &maxY, double R)
+{
+	__buildUnservedSAT();
+
+	std::vector<std::pair<int, int> > candidates; // pair of upper bound and negative lattice index
+	candidates.reserve(countX*countY);
+	for (int i = 0; i < countX; ++i)
+		for (int j = 0; j < countY; ++j)
+			if (deployAllowed[i][j] == 1)
+				candidates.push_back(std::pair<int, int>(__discUpperBound(Point(margin + i*DETECT, margin + j*DETECT), R), -(i*countY + j)));
+	std::sort(candidates.begin(), candidates.end(), std::greater<std::pair<int, int> >());
+
+	int maxUnservedNearby = -1, maxIdx = -1;
+	size_t k = 0;
+	for (; k < candidates.size(); ++k)
+	{
+		int upperBound = candidates[k].first, idx = -candidates[k].second;
+		if (upperBound < maxUnservedNearby)
+			break;
+		if (upperBound == maxUnservedNearby && idx > maxIdx)
+			continue;
+		int unservedNearby = __countUnservedNearby(Point(margin + idx/countY*DETECT, margin + idx%countY*DETECT), R);
+		if (maxUnservedNearby < unservedNearby || (maxUnservedNearby == unservedNearby && idx < maxIdx))
+		{
+			maxUnservedNearby = unservedNearby;
+			maxIdx = idx;
+		}
+	}
+	if (maxIdx >= 0)
+		maxX = margin + maxIdx/countY*DETECT, maxY = margin + maxIdx%countY*DETECT;
+	info_log("summed-area scan: %lu candidates, %lu bounded, maxUnservedNearby: %d\n", candidates.size(), k, maxUnservedNearby);
+	return maxUnservedNearby;
+}
+
+/**
+ * Lattice points are grouped in blocks of COARSE x COARSE, and every block is bounded from above by the number of
+ * unserved users within R of any of its lattice points, which is read from the summed-area table. Blocks are refined in
+ * descending order of their bounds by counting their allowed lattice points exactly. With coarseTopK == 0 the scan
+ * stops only when no remaining bound can beat the best exact count, so the placement is the same as the brute force
+ * scan, otherwise only the coarseTopK blocks of the largest bounds are refined. The bound counts the users of a
+ * disc widened by (COARSE-1)*DETECT, which is loose, so without coarseTopK most blocks are refined and the
+ * summed-area scan is faster.
+ */
+int Solution::__coarseFineScan(double &maxX, double &maxY, double R)
+{
+	__buildUnservedSAT();
+
+	int xBlockNum = (countX + COARSE - 1) / COARSE, yBlockNum = (countY + COARSE - 1) / COARSE;
+	std::vector<std::pair<int, int> > blocks(xBlockNum*yBlockNum); // pair of upper bound and negative block index
+	for (int bi = 0; bi < xBlockNum; ++bi)
+	{
+		for (int bj = 0; bj < yBlockNum; ++bj)
+		{
+			int upperBound = __blockUpperBound(bi*COARSE, std::min(bi*COARSE + COARSE, countX), bj*COARSE, std::min(bj*COARSE + COARSE, countY), R);
+			blocks[bi*yBlockNum + bj] = std::pair<int, int>(upperBound, -(bi*yBlockNum + bj));
+		}
+	}
+	std::sort(blocks.begin(), blocks.end(), std::greater<std::pair<int, int> >());
+
+	int maxUnservedNearby = -1, maxIdx = -1;
+	size_t k = 0;
+	for (; k < blocks.size(); ++k)
+	{
+		if (coarseTopK > 0 && k == static_cast<size_t>(coarseTopK) && maxIdx >= 0)
+			break;
+		int upperBound = blocks[k].first, bi = -blocks[k].second / yBlockNum, bj = -blocks[k].second % yBlockNum;
+		if (upperBound < maxUnservedNearby)
+			break;
+		// blocks of equal bounds come in increasing index, so their first lattice points increase as well
+		if (upperBound == maxUnservedNearby && bi*COARSE*countY + bj*COARSE > maxIdx)
+			break;
+		for (int i = bi*COARSE; i < std::min(bi*COARSE + COARSE, countX); ++i)
+		{
+			for (int j = bj*COARSE; j < std::min(bj*COARSE + COARSE, countY); ++j)
+			{
+				if (deployAllowed[i][j] == 0)
+					continue;
+				int idx = i*countY + j, unservedNearby = __countUnservedNearby(Point(margin + i*DETECT, margin + j*DETECT), R);
+				if (maxUnservedNearby < unservedNearby || (maxUnservedNearby == unservedNearby && idx < maxIdx))
+				{
+					maxUnservedNearby = unservedNearby;
+					maxIdx = idx;
+				}
+			}
+		}
+	}
+	if (maxIdx >= 0)
+		maxX = margin + maxIdx/countY*DETECT, maxY = margin + maxIdx%countY*DETECT;
+	info_log("coarse-to-fine scan: %lu blocks, %lu refined, maxUnservedNearby: %d\n", blocks.size(), k, maxUnservedNearby);
+	return maxUnservedNearby;
+}
+
+/**
+ * unserved users in the buckets intersecting the union of the discs of radius R around lattice points
+ * [iBegin, iEnd) x [jBegin, jEnd), which is their bounding box widened by R with rounded corners, row by row
+ * as __discUpperBound() does.
+ */
+int Solution::__blockUpperBound(int iBegin, int iEnd, int jBegin, int jEnd, double R)
+{
+	double xLow = margin + iBegin*DETECT, xHigh = margin + (iEnd-1)*DETECT;
+	double yLow = margin + jBegin*DETECT, yHigh = margin + (jEnd-1)*DETECT;
+	int upperBound = 0;
+	int nBegin = std::max(static_cast<int>(floor((yLow - R)/DETECT)), 0);
+	int nEnd = std::min(static_cast<int>(floor((yHigh + R)/DETECT)), yBucketNum-1);
+	for (int n = nBegin; n <= nEnd; ++n)
+	{
+		double dy = 0.0;
+		if (yHigh < n*DETECT)
+			dy = n*DETECT - yHigh;
+		else if (yLow > (n+1)*DETECT)
+			dy = yLow - (n+1)*DETECT;
+		if (dy >= R)
+			continue;
+		double halfWidth = sqrt(R*R - dy*dy) + 1e-6; // precision consideration
+		int mBegin = std::max(static_cast<int>(floor((xLow - halfWidth)/DETECT)), 0);
+		int mEnd = std::min(static_cast<int>(floor((xHigh + halfWidth)/DETECT)), xBucketNum-1);
+		if (mBegin <= mEnd)
+			upperBound += unservedSAT[mEnd+1][n+1] - unservedSAT[mBegin][n+1] - unservedSAT[mEnd+1][n] + unservedSAT[mBegin][n];
+	}
+	return upperBound;
+}
+
+void Solution::__buildUnservedSAT()
+{
+	for (int m = 0; m < xBucketNum; ++m)
+		for (int n = 0; n < yBucketNum; ++n)
+			unservedSAT[m+1][n+1] = buckets.size(m, n) + unservedSAT[m][n+1] + unservedSAT[m+1][n] - unservedSAT[m][n];
+}
+
+int Solution::__discUpperBound(const Point& coord, double R)
+{
+	int upperBound = 0;
+	int nBegin = std::max(static_cast<int>(floor((coord.y - R)/DETECT)), 0);
+	int nEnd = std::min(static_cast<int>(floor((coord.y + R)/DETECT)), yBucketNum-1);
+	for (int n = nBegin; n <= nEnd; ++n)
+	{
+		double dy = 0.0;
+		if (coord.y < n*DETECT)
+			dy = n*DETECT - coord.y;
+		else if (coord.y > (n+1)*DETECT)
+			dy = coord.y - (n+1)*DETECT;
+		if (dy >= R)
+			continue;
+		double halfWidth = sqrt(R*R - dy*dy) + 1e-6; // precision consideration
+		int mBegin = std::max(static_cast<int>(floor((coord.x - halfWidth)/DETECT)), 0);
+		int mEnd = std::min(static_cast<int>(floor((coord.x + halfWidth)/DETECT)), xBucketNum-1);
+		if (mBegin <= mEnd)
+			upperBound += unservedSAT[mEnd+1][n+1] - unservedSAT[mBegin][n+1] - unservedSAT[mEnd+1][n] + unservedSAT[mBegin][n];
+	}
+	return upperBound;
+}
+
+int Solution::__countUnservedNearby(const Point& coord, double R)
+{
+	int xIdx = static_cast<int>((coord.x - margin)/DETECT), yIdx = static_cast<int>((coord.y - margin)/DETECT);
+	int xBegin = std::max(xIdx - outsideBucketNum, 0), xEnd = std::min(xIdx + initialBucketNum, xBucketNum);
+	int yBegin = std::max(yIdx - outsideBucketNum, 0), yEnd = std::min(yIdx + initialBucketNum, yBucketNum);
+	int unservedNearby = 0;
+	if (yBegin >= yEnd) // coord is far off the map
+		return 0;
+	for (int m = xBegin; m < xEnd; ++m)
+	{
+		int sBegin = buckets.stripBegin(m, yBegin), sEnd = buckets.stripEnd(m, yEnd);
+		unservedNearby += kernel::countInDisc(buckets.x.data() + sBegin, buckets.y.data() + sBegin, sEnd - sBegin, coord, R);
+	}
+	return unservedNearby;
+}
+
+/** call visit(user, slot) for every unserved user within R of coord, whose coordinates are at slot of buckets. */
+template <class _Visitor>
+void Solution::__visitUnservedNearby(const Point& coord, double R, _Visitor visit)
+{
+	int xIdx = static_cast<int>((coord.x - margin)/DETECT), yIdx = static_cast<int>((coord.y - margin)/DETECT);
+	int xBegin = std::max(xIdx - outsideBucketNum, 0), xEnd = std::min(xIdx + initialBucketNum, xBucketNum);
+	int yBegin = std::max(yIdx - outsideBucketNum, 0), yEnd = std::min(yIdx + initialBucketNum, yBucketNum);
+	if (yBegin >= yEnd) // coord is far off the map
+		return;
+	for (int m = xBegin; m < xEnd; ++m)
+	{
+		int sBegin = buckets.stripBegin(m, yBegin), sEnd = buckets.stripEnd(m, yEnd);
+		int selectedNum = kernel::selectInDisc(buckets.x.data() + sBegin, buckets.y.data() + sBegin, sEnd - sBegin, coord, R, selected.data());
+		for (int k = 0; k < selectedNum; ++k)
+			if (!context.servedTable.test(buckets.id[sBegin + selected[k]]))
+				visit(buckets.id[sBegin + selected[k]], sBegin + selected[k]);
+	}
+}
+
+/**
+ * Same placement as the brute force scan. coverScore of every lattice point is gathered from the buckets as the
+ * brute force scan does on the first call, then __handleBuckets keeps it up to date by delta as users are served
+ * and unserved, and __rescoreRadius moves it to the larger radius of each later UAV. The best allowed lattice
+ * point is the winner of scoreTree.
+ */
+int Solution::__incrementalScan(double &maxX, double &maxY, double R)
+{
+	if (scoreR < 0.0 || R < scoreR)
+	{
+		coverScore.resize(countX*countY);
+		pool.run(countX, threadNum, [this, R](int, int i) {
+			for (int j = 0; j < countY; ++j)
+				coverScore[i*countY + j] = __countUnservedNearby(Point(margin + i*DETECT, margin + j*DETECT), R);
+		});
+		scoreR = R;
+		rowRange.resize(static_cast<size_t>(context.numUser)*rowSpan*2);
+		for (int m = 0; m < xBucketNum; ++m)
+			for (int n = 0; n < yBucketNum; ++n)
+				for (int s = buckets.begin(m, n); s < buckets.end(m, n); ++s)
+					__boundUserRows(buckets.id[s], Point(buckets.x[s], buckets.y[s]));
+		std::vector<int> keys(coverScore);
+		for (int i = 0; i < countX; ++i)
+			for (int j = 0; j < countY; ++j)
+				if (deployAllowed[i][j] == 0)
+					keys[i*countY + j] = -1;
+		scoreTree.initialize(keys);
+		info_log("incremental scan: build scores with radius %f\n", R);
+	}
+	else
+	{
+		if (scoreR < R)
+			__rescoreRadius(R);
+		for (int i = 0; i < countX; ++i)
+		{
+			for (int j = 0; j < countY; ++j)
+			{
+				int idx = i*countY + j, key = deployAllowed[i][j] == 1 ? coverScore[idx] : -1;
+				if (scoreTree.key(idx) != key)
+					scoreTree.update(idx, key);
+			}
+		}
+	}
+	int maxIdx = scoreTree.top(), maxUnservedNearby = scoreTree.key(maxIdx);
+
+	if (maxUnservedNearby >= 0)
+		maxX = margin + maxIdx/countY*DETECT, maxY = margin + maxIdx%countY*DETECT;
+	// no scan follows the last UAV, stop maintaining scores
+	if (UAVs.size() >= static_cast<size_t>(numAvailableUAV))
+		scoreR = -1.0;
+	return maxUnservedNearby;
+}
+
+/**
+ * move coverScore from radius scoreR to a larger R. Each unserved user keeps the range of lattice points within
+ * scoreR of it in every row, so only the lattice points its ranges gain are visited and at most two of them are
+ * tested in vain per row. The work is linear in the unserved users and in R/DETECT, while rebuilding the scores
+ * would take the users within R of every lattice point.
+ */
+void Solution::__rescoreRadius(double R)
+{
+	for (int m = 0; m < xBucketNum; ++m)
+	{
+		for (int n = 0; n < yBucketNum; ++n)
+		{
+			for (int s = buckets.begin(m, n); s < buckets.end(m, n); ++s)
+			{
+				Point U(buckets.x[s], buckets.y[s]);
+				int firstRow = _floorInt((U.x - maxRadius - margin)/DETECT);
+				int iBegin = std::max(_floorInt((U.x - R - margin)/DETECT), 0), iEnd = std::min(_ceilInt((U.x + R - margin)/DETECT), countX-1);
+				int *range = &rowRange[static_cast<size_t>(buckets.id[s])*rowSpan*2];
+				for (int i = iBegin; i <= iEnd; ++i)
+				{
+					__growRowRange(U, i, R, range[(i - firstRow)*2], range[(i - firstRow)*2 + 1], [this](int row, int col) {
+						++coverScore[row*countY + col];
+					});
+				}
+			}
+		}
+	}
+	info_log("incremental scan: rescore from radius %f to %f\n", scoreR, R);
+	scoreR = R;
+}
+
+/** set the ranges of lattice points within scoreR of user in every row it can reach, see __rescoreRadius(). */
+void Solution::__boundUserRows(int user, const Point& U)
+{
+	int firstRow = _floorInt((U.x - maxRadius - margin)/DETECT);
+	int nearest = std::min(std::max(_floorInt((U.y - margin)/DETECT), 0), countY-1);
+	int *range = &rowRange[static_cast<size_t>(user)*rowSpan*2];
+	for (int k = 0; k < rowSpan; ++k)
+	{
+		int i = firstRow + k;
+		range[k*2] = range[k*2 + 1] = nearest;
+		if (i >= 0 && i < countX)
+			__growRowRange(U, i, scoreR, range[k*2], range[k*2 + 1], [](int, int) {});
+	}
+}
+
+/** add delta to coverScore of the lattice points within scoreR of an unserved user at U. */
+void Solution::__scoreUser(const Point& U, int delta, bool updateTree)
+{
+	__visitLatticeNear(U, scoreR, [this, delta, updateTree](int i, int j) {
+		int idx = i*countY + j;
+		coverScore[idx] += delta;
+		if (updateTree && deployAllowed[i][j] == 1)
+			scoreTree.update(idx, coverScore[idx]);
+	});
+}
+
+/**
+ * Same placement as the brute force scan. Counts only decrease as users are served, so the last known count of
+ * a lattice point is an upper bound of its current count, and the lattice point popped with a count refreshed in
+ * this round is the best one. Bounds start from the summed-area table whenever the radius changes, and users
+ * released by __handleBuckets raise the bounds around them.
+ */
+int Solution::__lazyGreedyScan(double &maxX, double &maxY, double R)
+{
+	if (lazyR != R)
+	{
+		__buildUnservedSAT();
+		lazyBound.resize(countX*countY);
+		lazyStamp.assign(countX*countY, 0);
+		for (int i = 0; i < countX; ++i)
+			for (int j = 0; j < countY; ++j)
+				lazyBound[i*countY + j] = __discUpperBound(Point(margin + i*DETECT, margin + j*DETECT), R);
+		lazyR = R;
+		__rebuildLazyHeap();
+	}
+	else if (lazyHeap.size() > 4*lazyBound.size())
+		__rebuildLazyHeap();
+
+	++lazyRound;
+	lazyEvaluated = 0;
+	int maxUnservedNearby = -1, maxIdx = -1;
+	std::vector<std::pair<int, int> > disallowed;
+	while (!lazyHeap.empty())
+	{
+		int bound = lazyHeap.top().first, idx = -lazyHeap.top().second;
+		if (bound != lazyBound[idx])
+		{
+			lazyHeap.pop();
+			continue;
+		}
+		if (deployAllowed[idx/countY][idx%countY] == 0)
+		{
+			disallowed.push_back(lazyHeap.top());
+			lazyHeap.pop();
+			continue;
+		}
+		if (lazyStamp[idx] == lazyRound)
+		{
+			maxUnservedNearby = bound, maxIdx = idx;
+			break;
+		}
+		lazyHeap.pop();
+		lazyBound[idx] = __countUnservedNearby(Point(margin + idx/countY*DETECT, margin + idx%countY*DETECT), R);
+		lazyStamp[idx] = lazyRound;
+		lazyHeap.push(std::pair<int, int>(lazyBound[idx], -idx));
+		++lazyEvaluated;
+	}
+	for (size_t k = 0; k < disallowed.size(); ++k)
+		lazyHeap.push(disallowed[k]);
+
+	if (maxIdx >= 0)
+		maxX = margin + maxIdx/countY*DETECT, maxY = margin + maxIdx%countY*DETECT;
+	lazySkipped = 0;
+	for (int i = 0; i < countX; ++i)
+		for (int j = 0; j < countY; ++j)
+			lazySkipped += deployAllowed[i][j];
+	lazySkipped -= lazyEvaluated;
+	info_log("lazy greedy scan: %d evaluations, %d skipped, maxUnservedNearby: %d\n", lazyEvaluated, lazySkipped, maxUnservedNearby);
+	// bounds of another radius are of no use, stop raising them until the next rebuild
+	if (UAVs.size() < static_cast<size_t>(numAvailableUAV) && UAV::radiusTable[__initialH(UAVs.size()+1)] != R)
+		lazyR = -1.0;
+	return maxUnservedNearby;
+}
+
+void Solution::__rebuildLazyHeap()
+{
+	std::vector<std::pair<int, int> > entries(lazyBound.size());
+	for (size_t idx = 0; idx < lazyBound.size(); ++idx)
+		entries[idx] = std::pair<int, int>(lazyBound[idx], -static_cast<int>(idx));
+	lazyHeap = std::priority_queue<std::pair<int, int> >(std::less<std::pair<int, int> >(), entries);
+}
+
+int Solution::__initialH(size_t uavNum)
+{
+	double deployProgress = static_cast<double>(uavNum) / numAvailableUAV;
+	return deployProgress*(UAV::maxH - beginH) + beginH;
+}
+
 void Solution::__adjustUAV(size_t uavIdx)
 {
 	UAV &curUAV = UAVs.back();
@@ -194,13 +1181,18 @@ void Solution::__adjustUAV(size_t uavIdx)
 	double maxOverlap = 100.0;
 	std::vector<std::pair<double, size_t> > conflictedUAVs;
 	std::set<int> conflictedBand;
-	for (; uavIdx < UAVs.size()-1; ++uavIdx)
+	std::vector<int> nearUAVs;
+	uavIndex.query(curUAV.getPos(), curUAV.getR(), nearUAVs);
+	for (size_t k = 0; k < nearUAVs.size(); ++k)
 	{
-		double distO2O = math::dist(curUAV.getPos(), UAVs[uavIdx].getPos()), distRpR = curUAV.getR() + UAVs[uavIdx].getR();
+		size_t idx = nearUAVs[k];
+		if (idx < uavIdx || idx == UAVs.size()-1)
+			continue;
+		double distO2O = math::dist(curUAV.getPos(), UAVs[idx].getPos()), distRpR = curUAV.getR() + UAVs[idx].getR();
 		if (distO2O < distRpR)
 		{
-			conflictedUAVs.push_back(std::pair<double, size_t>(distO2O/distRpR, uavIdx));
-			conflictedBand.insert(UAVs[uavIdx].getBand());
+			conflictedUAVs.push_back(std::pair<double, size_t>(distO2O/distRpR, idx));
+			conflictedBand.insert(UAVs[idx].getBand());
 			if (distO2O/distRpR >= 0.9)
 				++littleOverlapNum;
 			if (maxOverlap > distO2O/distRpR)
@@ -267,6 +1259,7 @@ void Solution::__adjustUAV(size_t uavIdx)
 
 		__unfeedServed(UAVs.size()-1);
 		__feedUnserved(UAVs.size()-1);
+		__syncUAVIndex(UAVs.size()-1);
 
 		totalServed += curUAV.userNum() - curServedNum;
 		info_log("move [cur]: (%.2f,%.2f), R: %.2f, N: %d  ==>  (%.2f,%.2f), R: %.2f, N: %d\n", curPos.x, curPos.y, curR, curServedNum, curUAV.getX(), curUAV.getY(), curUAV.getR(), curUAV.userNum());
@@ -289,6 +1282,30 @@ void Solution::__adjustUAV(size_t uavIdx)
 	}
 }
 
+/**
+ * evaluate eval(angle) of every angle on threadNum threads, and return the index of the first angle whose value
+ * is the largest and above maxValue, or -1 if there is none, the same as a serial scan keeping the first strictly
+ * larger value. maxValue is raised to the largest value found.
+ */
+template <class _Eval>
+int Solution::__bestAngle(const std::vector<double>& angles, int& maxValue, _Eval eval)
+{
+	std::vector<int> values(angles.size());
+	pool.run(static_cast<int>(angles.size()), threadNum, [&angles, &values, &eval](int, int k) {
+		values[k] = eval(angles[k]);
+	});
+	int bestIdx = -1;
+	for (size_t k = 0; k < values.size(); ++k)
+	{
+		if (maxValue < values[k])
+		{
+			maxValue = values[k];
+			bestIdx = static_cast<int>(k);
+		}
+	}
+	return bestIdx;
+}
+
 void Solution::__alterUAV(size_t uavIdx)
 {
 	UAV &curUAV = UAVs.back();
@@ -299,17 +1316,27 @@ void Solution::__alterUAV(size_t uavIdx)
 		return;
 
 	bool adjustOld = oldUAV.userNum() < oldUAV.getMaxU();
-	double newR = (oldUAV.getR() + curUAV.getR()) / 2, deltaAngle = M_PI / 18.0;
+	double newR = (oldUAV.getR() + curUAV.getR()) / 2, deltaAngle = M_PI / alterDivisions;
 	Point midOO((oldUAV.getX()+curUAV.getX())/2, (oldUAV.getY()+curUAV.getY())/2);
-	for (size_t idx = 0; idx < UAVs.size()-1; ++idx)
+	std::vector<int> nearUAVs;
+	uavIndex.query(oldUAV.getPos(), oldUAV.getR(), nearUAVs, oldUAV.getBand(), oc3);
+	for (size_t k = 0; k < nearUAVs.size(); ++k)
 	{
-		if (idx == uavIdx)
+		size_t idx = nearUAVs[k];
+		if (idx == uavIdx || idx == UAVs.size()-1)
 			continue;
 		double distO2O = math::dist(oldUAV.getPos(), UAVs[idx].getPos()), distRpR = oldUAV.getR() + UAVs[idx].getR();
-		if (distO2O/distRpR < oc3 && oldUAV.getBand() == UAVs[idx].getBand())
+		if (distO2O/distRpR < oc3)
 			adjustOld = false;
-		distO2O = math::dist(midOO, UAVs[idx].getPos());
-		if (newR > (distO2O - UAVs[idx].getR())/2 && oldUAV.getBand() == UAVs[idx].getBand())
+	}
+	uavIndex.query(midOO, 2*newR, nearUAVs, oldUAV.getBand()); // newR only shrinks, so a UAV out of reach of the initial newR is never limiting
+	for (size_t k = 0; k < nearUAVs.size(); ++k)
+	{
+		size_t idx = nearUAVs[k];
+		if (idx == uavIdx || idx == UAVs.size()-1)
+			continue;
+		double distO2O = math::dist(midOO, UAVs[idx].getPos());
+		if (newR > (distO2O - UAVs[idx].getR())/2)
 			newR = (distO2O - UAVs[idx].getR())/2;
 	}
 
@@ -320,27 +1347,21 @@ void Solution::__alterUAV(size_t uavIdx)
 	{
 		info_log("adjust both oldUAV and curUAV.\n");
 
-		oldUAV.setX(-gX), oldUAV.setY(-gY);
-		curUAV.setX(-gX), curUAV.setY(-gY);
+		oldUAV.setX(-context.gX), oldUAV.setY(-context.gY);
+		curUAV.setX(-context.gX), curUAV.setY(-context.gY);
 		__unfeedServed(uavIdx);
 		__unfeedServed(UAVs.size()-1);
 
-		size_t maxUnservedNum = 0;
-		double optimalAngle = 0.0;
+		std::vector<double> angles;
 		for (double angle = 0.0; angle < 3.1415926; angle += deltaAngle)
-		{
-			std::list<int> unservedList;
-			__attainUnservedList(midOO.x + newR*cos(angle), midOO.y + newR*sin(angle), newR, unservedList);
-			size_t unservedNum = unservedList.size();
-			__attainUnservedList(midOO.x - newR*cos(angle), midOO.y - newR*sin(angle), newR, unservedList);
-			unservedNum += unservedList.size();
-			if (maxUnservedNum < unservedNum)
-			{
-				maxUnservedNum = unservedNum;
-				optimalAngle = angle;
-			}
-		}
-		info_log("newR: %f, maxUnservedNum: %lu, optimalAngle: %f\n", newR, maxUnservedNum, optimalAngle);
+			angles.push_back(angle);
+		int maxUnservedNum = 0;
+		int optimalIdx = __bestAngle(angles, maxUnservedNum, [this, &midOO, newR](double angle) {
+			return __countUnservedNearby(Point(midOO.x + newR*cos(angle), midOO.y + newR*sin(angle)), newR)
+				+ __countUnservedNearby(Point(midOO.x - newR*cos(angle), midOO.y - newR*sin(angle)), newR);
+		});
+		double optimalAngle = optimalIdx >= 0 ? angles[optimalIdx] : 0.0;
+		info_log("newR: %f, maxUnservedNum: %d, optimalAngle: %f\n", newR, maxUnservedNum, optimalAngle);
 
 		double xi = -1.0;
 		oldUAV.setX(midOO.x + newR*cos(optimalAngle)), oldUAV.setY(midOO.y + newR*sin(optimalAngle));
@@ -357,7 +1378,9 @@ void Solution::__alterUAV(size_t uavIdx)
 		__feedUnserved(UAVs.size()-1);
 
 		if (oldUAV.userNum() == oldUAV.getMaxU())
-			oldUAV.adjust();
+			oldUAV.adjust(random);
+		__syncUAVIndex(uavIdx);
+		__syncUAVIndex(UAVs.size()-1);
 
 		totalServed += oldUAV.userNum() - oldServedNum + curUAV.userNum() - curServedNum;
 		info_log("move [old]: (%.2f,%.2f), R: %.2f, N: %d  ==>  (%.2f,%.2f), R: %.2f, N: %d", oldPos.x, oldPos.y, oldR, oldServedNum, oldUAV.getX(), oldUAV.getY(), oldUAV.getR(), oldUAV.userNum());
@@ -372,36 +1395,27 @@ void Solution::__alterUAV(size_t uavIdx)
 	{
 		info_log("only adjust curUAV.\n");
 
-		curUAV.setX(-gX), curUAV.setY(-gY);
+		curUAV.setX(-context.gX), curUAV.setY(-context.gY);
 		__unfeedServed(UAVs.size()-1);
 
-		int maxUnservedNum = 0;
-		double optimalAngle = -2.0;
 		Point newPos;
 		oldR = oldUAV.getR(), curR = curUAV.getR(), newR = oldR + curR + 1.0; // precision consideration
+		uavIndex.query(oldUAV.getPos(), newR + curR, nearUAVs, curUAV.getBand()); // every newPos is within newR of oldUAV
+		std::vector<double> angles;
 		for (double angle = 0.0; angle < 6.2831852; angle += deltaAngle)
-		{
-			newPos.x = oldUAV.getX() + newR*cos(angle), newPos.y = oldUAV.getY() + newR*sin(angle);
-			bool skip = false;
-			for (size_t idx = 0; idx < UAVs.size()-1; ++idx)
-			{
-				if (idx != uavIdx && curUAV.getBand() == UAVs[idx].getBand() && math::dist(newPos, UAVs[idx].getPos()) < curR + UAVs[idx].getR())
-				{
-					skip = true;
-					break;
-				}
-			}
-			if (skip)
-				continue;
-			std::list<int> unservedList;
-			__attainUnservedList(newPos.x, newPos.y, curR, unservedList);
-			int unservedNum = static_cast<int>(unservedList.size());
-			if (maxUnservedNum < unservedNum)
+			angles.push_back(angle);
+		int maxUnservedNum = 0;
+		int optimalIdx = __bestAngle(angles, maxUnservedNum, [this, &oldUAV, &nearUAVs, uavIdx, newR, curR](double angle) {
+			Point pos(oldUAV.getX() + newR*cos(angle), oldUAV.getY() + newR*sin(angle));
+			for (size_t k = 0; k < nearUAVs.size(); ++k)
 			{
-				maxUnservedNum = unservedNum;
-				optimalAngle = angle;
+				size_t idx = nearUAVs[k];
+				if (idx != uavIdx && idx != UAVs.size()-1 && math::dist(pos, UAVs[idx].getPos()) < curR + UAVs[idx].getR())
+					return -1; // conflicts with a UAV of the same band
 			}
-		}
+			return __countUnservedNearby(pos, curR);
+		});
+		double optimalAngle = optimalIdx >= 0 ? angles[optimalIdx] : -2.0;
 		if (optimalAngle > -1.0 && maxUnservedNum >= curServedNum/3)
 		{
 			info_log("maxUnservedNum: %d, optimalAngle: %f\n", maxUnservedNum, optimalAngle);
@@ -420,6 +1434,7 @@ void Solution::__alterUAV(size_t uavIdx)
 
 		curUAV.setPos(newPos);
 		__feedUnserved(UAVs.size()-1);
+		__syncUAVIndex(UAVs.size()-1);
 
 		totalServed += curUAV.userNum() - curServedNum;
 		info_log("move [cur]: (%.2f,%.2f), R: %.2f, N: %d  ==>  (%.2f,%.2f), R: %.2f, N: %d\n", curPos.x, curPos.y, curR, curServedNum, curUAV.getX(), curUAV.getY(), curUAV.getR(), curUAV.userNum());
@@ -436,22 +1451,43 @@ void Solution::__expandUAV(size_t uavIdx, size_t ignoreIdx, const Point& Q, doub
 
 	size_t nearestIdx = 1000;
 	double deltaR = 5.0, maxAllowedRadius = maxRadius;
-	for (size_t idx = 0; idx < UAVs.size()-1; ++idx)
+	std::vector<int> nearUAVs;
+	uavIndex.query(_pos, maxRadius, nearUAVs, uav.getBand());
+	for (size_t k = 0; k < nearUAVs.size(); ++k)
 	{
-		if (idx == uavIdx || idx == ignoreIdx)
+		size_t idx = nearUAVs[k];
+		if (idx == uavIdx || idx == ignoreIdx || idx == UAVs.size()-1)
 			continue;
 		double allowedRadius = math::dist(_pos, UAVs[idx].getPos()) - UAVs[idx].getR();
-		if (maxAllowedRadius > allowedRadius && uav.getBand() == UAVs[idx].getBand())
+		if (maxAllowedRadius > allowedRadius)
 		{
 			maxAllowedRadius = allowedRadius;
 			nearestIdx = idx;
 		}
 	}
 
+	// discs of radius r centered at Q + xi*r*(cos(vartheta), sin(vartheta)) all touch Q and grow with r, user P is
+	// covered once r > |PQ|^2 / (2*xi*(P-Q).(cos(vartheta), sin(vartheta))), so the expansion stops once r exceeds
+	// the getMaxU()-th smallest of these radii among the unserved users covered by the largest allowed disc
+	double stopR = maxAllowedRadius;
 	if ((newR = _R + deltaR) < maxAllowedRadius)
 	{
-		uav.setX(-gX), uav.setY(-gY);
+		uav.setX(-context.gX), uav.setY(-context.gY);
 		__unfeedServed(uavIdx);
+
+		std::vector<double> &coverR = coverRScratch;
+		coverR.clear();
+		Point farthest(Q.x + xi*maxAllowedRadius*cos(vartheta), Q.y + xi*maxAllowedRadius*sin(vartheta));
+		__visitUnservedNearby(farthest, maxAllowedRadius, [this, &coverR, &Q, vartheta, xi, maxAllowedRadius](int, int slot) {
+			double dx = buckets.x[slot] - Q.x, dy = buckets.y[slot] - Q.y;
+			double toward = xi*(dx*cos(vartheta) + dy*sin(vartheta));
+			coverR.push_back(toward > 0.0 ? (dx*dx + dy*dy)/(2*toward) : maxAllowedRadius);
+		});
+		if (static_cast<int>(coverR.size()) >= uav.getMaxU())
+		{
+			std::nth_element(coverR.begin(), coverR.begin() + uav.getMaxU()-1, coverR.end());
+			stopR = coverR[uav.getMaxU()-1];
+		}
 	}
 	while (newR < maxAllowedRadius)
 	{
@@ -459,14 +1495,13 @@ void Solution::__expandUAV(size_t uavIdx, size_t ignoreIdx, const Point& Q, doub
 		newR += deltaR;
 		if (nearestIdx != 1000 && newR >= math::dist(uav.getPos(), UAVs[nearestIdx].getPos()) - UAVs[nearestIdx].getR())
 			break;
-		std::list<int> unservedList;
-		__attainUnservedList(uav.getX(), uav.getY(), newR - deltaR, unservedList);
-		if (static_cast<int>(unservedList.size()) >= uav.getMaxU())
+		if (newR - deltaR > stopR)
 			break;
 	}
 	uav.setR(newR - deltaR, true);
 
 	__feedUnserved(uavIdx);
+	__syncUAVIndex(uavIdx);
 
 	totalServed += uav.userNum() - _servedNum;
 	info_log("expand: (%.2f,%.2f), R: %.2f, N: %d  ==>  (%.2f,%.2f), R: %.2f, N: %d\n", _pos.x, _pos.y, _R, _servedNum, uav.getX(), uav.getY(), uav.getR(), uav.userNum());
@@ -480,9 +1515,12 @@ bool Solution::__tangentUAV(size_t uavIdx, Point& newPos, std::vector<size_t> co
 	if (conflictedUAVs.size() < 2)
 	{
 		std::vector<std::pair<double, size_t> > sortConflictedUAVs;
-		for (size_t idx = 0; idx < UAVs.size()-1; ++idx)
+		std::vector<int> nearUAVs;
+		uavIndex.query(newPos, uav.getR(), nearUAVs, uav.getBand(), oc3);
+		for (size_t k = 0; k < nearUAVs.size(); ++k)
 		{
-			if (idx == uavIdx || uav.getBand() != UAVs[idx].getBand())
+			size_t idx = nearUAVs[k];
+			if (idx == uavIdx || idx == UAVs.size()-1)
 				continue;
 			double overlap = math::dist(newPos, UAVs[idx].getPos()) / (uav.getR() + UAVs[idx].getR());
 			if (overlap < oc3)
@@ -515,12 +1553,15 @@ bool Solution::__tangentUAV(size_t uavIdx, Point& newPos, std::vector<size_t> co
 			if (newR >= minRadius && newR <= maxRadius && math::dist(curPos, newPos) < maxRadius)
 			{
 				double maxReduceR = -1.0;
-				for (size_t idx = 0; idx < UAVs.size()-1; ++idx)
+				std::vector<int> nearUAVs;
+				uavIndex.query(newPos, newR + 1.0, nearUAVs, uav.getBand()); // distRpR - distO2O > -1.0
+				for (size_t k = 0; k < nearUAVs.size(); ++k)
 				{
-					if (idx == cIdx0 || idx == cIdx1 || idx == cIdx2)
+					size_t idx = nearUAVs[k];
+					if (idx == cIdx0 || idx == cIdx1 || idx == cIdx2 || idx == UAVs.size()-1)
 						continue;
 					double distO2O = math::dist(newPos, UAVs[idx].getPos()), distRpR = newR + UAVs[idx].getR();
-					if (maxReduceR < distRpR - distO2O && uav.getBand() == UAVs[idx].getBand())
+					if (maxReduceR < distRpR - distO2O)
 						maxReduceR = distRpR - distO2O;
 				}
 				info_log("maxReduceR: %f\n", maxReduceR);
@@ -566,12 +1607,15 @@ bool Solution::__tangentUAV(size_t uavIdx, Point& newPos, std::vector<size_t> co
 
 		size_t nearestIdx = 1000;
 		double maxReduceR = -1.0;
-		for (size_t idx = 0; idx < UAVs.size()-1; ++idx)
+		std::vector<int> nearUAVs;
+		uavIndex.query(newPos, uav.getR() + 1.0, nearUAVs, uav.getBand()); // distRpR - distO2O > -1.0
+		for (size_t k = 0; k < nearUAVs.size(); ++k)
 		{
-			if (idx == cIdx0 || idx == cIdx1)
+			size_t idx = nearUAVs[k];
+			if (idx == cIdx0 || idx == cIdx1 || idx == UAVs.size()-1)
 				continue;
 			double distO2O = math::dist(newPos, UAVs[idx].getPos()), distRpR = uav.getR() + UAVs[idx].getR();
-			if (maxReduceR < distRpR - distO2O && uav.getBand() == UAVs[idx].getBand())
+			if (maxReduceR < distRpR - distO2O)
 			{
 				maxReduceR = distRpR - distO2O;
 				nearestIdx = idx;
@@ -602,9 +1646,11 @@ bool Solution::__assignBand()
 		bandUsed.insert(std::pair<int, bool>(Band::_2_2, false));
 	if (UAV::bandNum > 2)
 		bandUsed.insert(std::pair<int, bool>(Band::_2_3, false));
-	for (size_t idx = 0; idx < UAVs.size()-1; ++idx)
-		if (math::dist(curUAV.getPos(), UAVs[idx].getPos()) < curUAV.getR() + UAVs[idx].getR() - 1.0)
-			bandUsed[UAVs[idx].getBand()] = true;
+	std::vector<int> nearUAVs;
+	uavIndex.query(curUAV.getPos(), curUAV.getR(), nearUAVs);
+	for (size_t k = 0; k < nearUAVs.size(); ++k)
+		if (static_cast<size_t>(nearUAVs[k]) != UAVs.size()-1 && math::dist(curUAV.getPos(), UAVs[nearUAVs[k]].getPos()) < curUAV.getR() + UAVs[nearUAVs[k]].getR() - 1.0)
+			bandUsed[UAVs[nearUAVs[k]].getBand()] = true;
 
 	bool conflicted = false;
 	if (UAV::bandNum > 1 && bandUsed[Band::_2_1])
@@ -625,16 +1671,22 @@ bool Solution::__assignBand()
 		curUAV.setBand(Band::_2_1);
 		conflicted = bandUsed[Band::_2_1];
 	}
+	__syncUAVIndex(UAVs.size()-1);
 	return !conflicted;
 }
 
+void Solution::__syncUAVIndex(size_t uavIdx)
+{
+	uavIndex.update(static_cast<int>(uavIdx), UAVs[uavIdx].getPos(), UAVs[uavIdx].getR(), UAVs[uavIdx].getBand());
+}
+
 void Solution::__unfeedServed(size_t uavIdx)
 {
 	assert(uavIdx < UAVs.size());
 
 	UAV &uav = UAVs[uavIdx];
 
-	std::vector<int> erased;
+	std::vector<int> &erased = erasedScratch;
 	uav.check(erased);
 	for (size_t k = 0; k < erased.size(); ++k)
 		__handleBuckets(erased[k], false);
@@ -647,49 +1699,56 @@ void Solution::__feedUnserved(size_t uavIdx)
 	UAV &uav = UAVs[uavIdx];
 	Point coord(uav.getPos());
 
-	std::list<int> unservedList;
-	__attainUnservedList(uav.getX(), uav.getY(), uav.getR(), unservedList);
-	if (!unservedList.empty())
-		unservedList.sort([&coord](const int& lhs, const int& rhs) {
-			return math::dist(groundUsers[lhs], coord) < math::dist(groundUsers[rhs], coord);
-		});
-	while (!unservedList.empty() && uav.userNum() < uav.getMaxU())
-	{
-		int curUsU = unservedList.front(); // alias
-		unservedList.pop_front();
-		uav.serve(curUsU); // must be UAV::Status::OK
-		__handleBuckets(curUsU, true);
-	}
+	int capacity = uav.getMaxU() - uav.userNum();
+	if (capacity <= 0)
+		return;
+	std::vector<int> &unserved = unservedScratch;
+	unserved.clear();
+	feedKeys.clear();
+	// only the closest capacity users are served, select them by squared distance, ties go to the earlier ones
+	__visitUnservedNearby(coord, uav.getR(), [this, &unserved, &coord](int user, int slot) {
+		double dx = buckets.x[slot] - coord.x, dy = buckets.y[slot] - coord.y;
+		feedKeys.push_back(std::pair<double, int>(dx*dx + dy*dy, static_cast<int>(unserved.size())));
+		unserved.push_back(user);
+	});
+	size_t servedNum = std::min(static_cast<size_t>(capacity), feedKeys.size());
+	std::partial_sort(feedKeys.begin(), feedKeys.begin() + servedNum, feedKeys.end());
+	for (size_t k = 0; k < servedNum; ++k)
+		feedKeys[k].second = unserved[feedKeys[k].second];
+	for (size_t k = 0; k < servedNum; ++k)
+		unserved[k] = feedKeys[k].second;
+
+	uav.serve(unserved.data(), static_cast<int>(servedNum)); // all must be served
+	for (size_t k = 0; k < servedNum; ++k)
+		__handleBuckets(unserved[k], true);
 }
 
 void Solution::__handleBuckets(int user, bool serve)
 {
-	assert(user < numUser);
+	assert(user < context.numUser);
 
-	int _xIdx = static_cast<int>(groundUsers[user].x) / DETECT;
-	int _yIdx = static_cast<int>(groundUsers[user].y) / DETECT;
+	// the coordinates are read from the live slot of user, before it is cleared by remove() or after insert()
+	if (!serve)
+		buckets.insert(user);
+	int slot = buckets.slot(user);
+	Point U(buckets.x[slot], buckets.y[slot]);
 	if (serve)
+		buckets.remove(user);
+	if (scoreR > 0.0)
 	{
-		itUS = std::find(buckets[_xIdx][_yIdx].begin(), buckets[_xIdx][_yIdx].end(), user);
-		assert(itUS != buckets[_xIdx][_yIdx].end());
-		buckets[_xIdx][_yIdx].erase(itUS);
+		__scoreUser(U, serve ? -1 : 1, true);
+		if (!serve)
+			__boundUserRows(user, U);
+	}
+	if (arcR > 0.0)
+		__markArcDirty(U, 0.0);
+	if (lazyR > 0.0 && !serve)
+	{
+		__visitLatticeNear(U, lazyR, [this](int i, int j) {
+			int idx = i*countY + j;
+			lazyHeap.push(std::pair<int, int>(++lazyBound[idx], -idx));
+		});
 	}
-	else
-		buckets[_xIdx][_yIdx].push_back(user);
-}
-
-void Solution::__attainUnservedList(double uavX, double uavY, double uavR, std::list<int>& unservedList)
-{
-	Point coord(uavX, uavY);
-	int xIdx = static_cast<int>((coord.x - margin)/DETECT), yIdx = static_cast<int>((coord.y - margin)/DETECT);
-	int xBegin = std::max(xIdx - outsideBucketNum, 0), xEnd = std::min(xIdx + initialBucketNum, xBucketNum);
-	int yBegin = std::max(yIdx - outsideBucketNum, 0), yEnd = std::min(yIdx + initialBucketNum, yBucketNum);
-	unservedList.clear();
-	for (int m = xBegin; m < xEnd; ++m)
-		for (int n = yBegin; n < yEnd; ++n)
-			for (itUS = buckets[m][n].begin(); itUS != buckets[m][n].end(); ++itUS)
-				if (servedTable[*itUS] == 0 && math::dist(groundUsers[*itUS], coord) < uavR)
-					unservedList.push_back(*itUS);
 }
 
 void Solution::result(const char *uavFile, const char *userFile)
@@ -714,9 +1773,9 @@ void Solution::result(const char *uavFile, const char *userFile)
 		exit(EXIT_FAILURE);
 	}
 
-	for (int i = 0; i < numUser; ++i)
-		if (servedTable[i] == 1)
-			fprintf(fd, "%.2f,%.2f\n", groundUsers[i].x, groundUsers[i].y);
+	for (int i = 0; i < context.numUser; ++i)
+		if (context.servedTable.test(i))
+			fprintf(fd, "%.2f,%.2f\n", context.groundUsers[i].x, context.groundUsers[i].y);
 
 	fclose(fd);
 }
@@ -20,15 +20,42 @@
 #define __BADBSP_H__
 
 #include "UAV.h"
+#include "Kernel.h"
+
+/** total served users after each UAV is deployed and seconds taken by Solution::deploy(), a row of statistic.csv. */
+struct DeployStatistic
+{
+	DeployStatistic() : elapse(0.0) {}
+
+	void print(FILE *fd) const;
+
+	std::vector<int> served;
+	double elapse;
+};
 
 class Solution
 {
 public:
 	enum Granularity {
-		DETECT = 50
+		DETECT = 50,
+		TILE = 4,  ///< the tiled scan evaluates TILE x TILE lattice points per pass.
+		COARSE = 8,   ///< the coarse scan bounds blocks of COARSE x COARSE lattice points first.
+		ARC_SECTOR = 32, ///< the arc sweep scan bounds each user by ARC_SECTOR arcs of its circle of centers first.
+		ARC_FINE = 4, ///< then the promising arcs by ARC_FINE arcs each over cells ARC_FINE times smaller.
+		BAND_SLOT = 8 ///< distinct bands counted per lattice point by the deployment mask.
 	};
 
-	Solution();
+	enum Engine {
+		BRUTE_FORCE, ///< count unserved users around every allowed lattice point.
+		SUMMED_AREA, ///< bound lattice points by summed-area table, count exactly only the survivors.
+		INCREMENTAL, ///< keep the count of every lattice point up to date as users are served and unserved.
+		LAZY_GREEDY, ///< re-count lattice points in a max-heap of their last known counts until a fresh one is on top.
+		TILED,       ///< count a tile of lattice points per pass over the cells around them.
+		ARC_SWEEP,   ///< search disc centers off the lattice by sweeping circles through every unserved user.
+		COARSE_FINE  ///< bound coarse blocks of lattice points by summed-area table, refine only the promising blocks.
+	};
+
+	explicit Solution(ScenarioContext& _context);
 
 	void deploy(int K, const char *statfile = NULL);
 	void result(const char *uavFile, const char *userFile);
@@ -39,20 +66,70 @@ private:
 	Solution(const Solution&);
 	Solution& operator=(const Solution&);
 
+	/** position, radius and band a UAV was last applied to the deployment mask with. */
+	struct DiscStamp {
+		Point pos;
+		double R;
+		int band;
+	};
+
 	int __findMaxCanServePlace(double& maxX, double& maxY, double R);
+	int __parallelScan(double& maxX, double& maxY, double R);
+	int __tiledScan(double& maxX, double& maxY, double R);
+	int __arcSweepScan(double& maxX, double& maxY, double R);
+	bool __deployAllowedAt(const Point& coord);
+	int __arcUpperBound(const Point& P, double R, int need, std::vector<int> *hot);
+	int __fineDiscUpperBound(const Point& coord, double R);
+	void __buildArcFineSAT();
+	void __staleArcCache(double R);
+	void __markArcDirty(const Point& coord, double r);
+	int __summedAreaScan(double& maxX, double& maxY, double R);
+	int __coarseFineScan(double& maxX, double& maxY, double R);
+	int __blockUpperBound(int iBegin, int iEnd, int jBegin, int jEnd, double R);
+	void __buildUnservedSAT();
+	int __discUpperBound(const Point& coord, double R);
+	int __countUnservedNearby(const Point& coord, double R);
+	int __incrementalScan(double& maxX, double& maxY, double R);
+	void __rescoreRadius(double R);
+	void __boundUserRows(int user, const Point& U);
+	template <class _Visitor>
+	void __growRowRange(const Point& U, int i, double r, int& jBegin, int& jEnd, _Visitor visit);
+	bool __latticeWithin(const Point& U, int i, int j, double r);
+	void __scoreUser(const Point& U, int delta, bool updateTree);
+	int __initialH(size_t uavNum);
+	int __lazyGreedyScan(double& maxX, double& maxY, double R);
+	void __rebuildLazyHeap();
+	template <class _Visitor>
+	void __visitLatticeNear(const Point& U, double R, _Visitor visit);
+	void __updateDeployAllowed();
+	void __applyDiscStamp(const DiscStamp& stamp, int delta);
+	int __bandSlot(int band);
+	bool __verifyDeployAllowed();
 	void __adjustUAV(size_t uavIdx);
 	void __alterUAV(size_t uavIdx);
+	template <class _Eval>
+	int __bestAngle(const std::vector<double>& angles, int& maxValue, _Eval eval);
 	void __expandUAV(size_t uavIdx, size_t ignoreIdx, const Point& Q, double vartheta, double xi);
 	bool __tangentUAV(size_t uavIdx, Point& newPos, std::vector<size_t> conficitedUAVs = std::vector<size_t>());
 
 	bool __assignBand();
+	void __syncUAVIndex(size_t uavIdx);
 	void __unfeedServed(size_t uavIdx);
 	void __feedUnserved(size_t uavIdx);
 	void __handleBuckets(int user, bool serve);
-	void __attainUnservedList(double uavX, double uavY, double uavR, std::list<int>& unservedList);
+	template <class _Visitor>
+	void __visitUnservedNearby(const Point& coord, double R, _Visitor visit);
 
 public:
+	ScenarioContext &context; ///< the case being solved, shared with every UAV.
+	DeployStatistic statistic; ///< filled by deploy().
 	int batch;
+	int engine;
+	int threadNum; ///< threads used by the brute force, tiled and arc sweep scans and the angle sweeps of __alterUAV.
+	ThreadPool pool; ///< runs all of them, so threads are spawned once per Solution rather than once per loop.
+	int alterDivisions; ///< __alterUAV rotates UAVs in steps of pi/alterDivisions.
+	bool verifyAllowed; ///< check the incremental deployAllowed against full recomputation after every deployOne().
+	int coarseTopK; ///< blocks refined by the coarse-to-fine scan, 0 refines every block that may hold the best lattice point.
 	int numAvailableUAV;
 	int totalServed;
 	int beginH;
@@ -65,13 +142,44 @@ public:
 	double minRadius;
 	double maxRadius;
 	double margin;
+	double scoreR; ///< radius coverScore is maintained for, negative when it is stale.
+	int rowSpan; ///< lattice rows a user can be within maxRadius of.
+	double lazyR;  ///< radius lazyBound is valid for, negative when it is stale.
+	double arcR;   ///< radius arcCovered is valid for, negative before the first arc sweep scan.
+	int lazyRound;
+	int lazyEvaluated; ///< exact counts done by the last lazy greedy scan.
+	int lazySkipped;   ///< allowed lattice points the last lazy greedy scan did not count.
 	const double oc1;
 	const double oc2;
 	const double oc3;
-	std::list<int>::iterator itUS;
+	Random random; ///< shuffles users of UAV::adjust(), seeded by main() so that runs are reproducible.
 	std::vector<UAV> UAVs;
+	DiscIndex uavIndex; ///< discs of UAVs, synchronized by __syncUAVIndex() whenever a UAV is moved or resized.
 	std::vector<std::vector<int> > deployAllowed;
-	std::vector<std::vector<std::list<int> > > buckets;
+	std::vector<DiscStamp> allowedStamps; ///< stamp of each UAV as counted by nearbyCount and bandCover.
+	std::vector<int> nearbyCount; ///< UAVs whose disc widened by the nearby distance contains each lattice point, indexed by i*countY + j.
+	std::vector<int> bandCover; ///< UAVs whose disc contains each lattice point by band slot, indexed by (i*countY + j)*BAND_SLOT + slot.
+	std::vector<int> bandMask; ///< bit of each band slot covering each lattice point.
+	std::vector<int> bandSlots; ///< band of each slot in order of first use.
+	BucketGrid buckets; ///< unserved users in cells of DETECT x DETECT.
+	std::vector<int> selected; ///< scratch of kernel::selectInDisc().
+	std::vector<int> unservedScratch; ///< scratch of __feedUnserved().
+	std::vector<std::pair<double, int> > feedKeys; ///< scratch of __feedUnserved(), pair of squared distance and position in unservedScratch.
+	std::vector<int> erasedScratch;   ///< scratch of __unfeedServed().
+	std::vector<double> coverRScratch; ///< scratch of __expandUAV().
+	std::vector<int> coverScore; ///< unserved users within scoreR of each lattice point (i,j), indexed by i*countY + j.
+	TournamentTree scoreTree; ///< coverScore of allowed lattice points, -1 for the others.
+	std::vector<int> rowRange; ///< range [jBegin, jEnd) of lattice points within scoreR of each unserved user in each of its rowSpan rows, indexed by (user*rowSpan + row)*2.
+	std::vector<int> lazyBound; ///< upper bound of unserved users within lazyR of each lattice point.
+	std::vector<int> lazyStamp; ///< the round in which lazyBound of each lattice point became exact.
+	std::priority_queue<std::pair<int, int> > lazyHeap; ///< pair of bound and negative lattice index, entries not equal to lazyBound are stale.
+	std::vector<int> arcCovered; ///< unserved users the best allowed disc of radius arcR through each user covers, -1 if none is allowed, -2 when stale.
+	std::vector<double> arcAngle; ///< angle of the center of that disc around the user.
+	std::vector<char> arcDirty; ///< cells whose users or lattice points changed since the last arc sweep scan, indexed by m*yBucketNum + n.
+	std::vector<Point> arcDirs; ///< unit vectors to the midpoints of the ARC_SECTOR arcs of a circle, then of its ARC_SECTOR*ARC_FINE arcs.
+	std::vector<int> arcFineSAT; ///< summed-area table of unserved users in cells of DETECT/ARC_FINE, see __buildArcFineSAT().
+	std::vector<std::pair<int, int> > arcOrder; ///< pair of negative __arcUpperBound() and slot of each stale user.
+	std::vector<std::vector<int> > unservedSAT; ///< summed-area table of bucket sizes, unservedSAT[m][n] sums buckets[0..m-1][0..n-1].
 };
 
 #endif /* __BADBSP_H__ */
@@ -0,0 +1,177 @@
+//
+// Copyright (C) 2017-2018 Xu Le <xmutongxinXuLe@163.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "Kernel.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KERNEL_HAS_AVX2    1
+#include <immintrin.h>
+#else
+#define KERNEL_HAS_AVX2    0
+#endif
+
+namespace kernel {
+
+static int _countInDiscScalar(const double *x, const double *y, int n, const Point& O, double R)
+{
+	int count = 0;
+	for (int k = 0; k < n; ++k)
+		if (math::dist(x[k], y[k], O) < R)
+			++count;
+	return count;
+}
+
+static int _selectInDiscScalar(const double *x, const double *y, int n, const Point& O, double R, int *selected)
+{
+	int count = 0;
+	for (int k = 0; k < n; ++k)
+		if (math::dist(x[k], y[k], O) < R)
+			selected[count++] = k;
+	return count;
+}
+
+static void _countInDiscsScalar(const double *x, const double *y, int n, const Point *O, int centerNum, double R, int *counts)
+{
+	for (int c = 0; c < centerNum; ++c)
+		counts[c] += _countInDiscScalar(x, y, n, O[c], R);
+}
+
+#if KERNEL_HAS_AVX2
+// squared distances below R^2*(1-eps) are surely in the disc, those above R^2*(1+eps) are surely out
+#define KERNEL_R2_EPS    1e-12
+
+__attribute__((target("avx2")))
+static int _countInDiscAVX2(const double *x, const double *y, int n, const Point& O, double R)
+{
+	__m256d ox = _mm256_set1_pd(O.x), oy = _mm256_set1_pd(O.y);
+	__m256d lo = _mm256_set1_pd(R*R*(1 - KERNEL_R2_EPS)), hi = _mm256_set1_pd(R*R*(1 + KERNEL_R2_EPS));
+	int count = 0, k = 0;
+	for (; k + 4 <= n; k += 4)
+	{
+		__m256d dx = _mm256_sub_pd(_mm256_loadu_pd(x + k), ox);
+		__m256d dy = _mm256_sub_pd(_mm256_loadu_pd(y + k), oy);
+		__m256d d2 = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+		int inMask = _mm256_movemask_pd(_mm256_cmp_pd(d2, lo, _CMP_LT_OQ));
+		int bandMask = _mm256_movemask_pd(_mm256_cmp_pd(d2, hi, _CMP_LT_OQ)) & ~inMask;
+		count += __builtin_popcount(inMask);
+		for (; bandMask != 0; bandMask &= bandMask - 1)
+		{
+			int l = __builtin_ctz(bandMask);
+			if (math::dist(x[k+l], y[k+l], O) < R)
+				++count;
+		}
+	}
+	return count + _countInDiscScalar(x + k, y + k, n - k, O, R);
+}
+
+__attribute__((target("avx2")))
+static int _selectInDiscAVX2(const double *x, const double *y, int n, const Point& O, double R, int *selected)
+{
+	__m256d ox = _mm256_set1_pd(O.x), oy = _mm256_set1_pd(O.y);
+	__m256d lo = _mm256_set1_pd(R*R*(1 - KERNEL_R2_EPS)), hi = _mm256_set1_pd(R*R*(1 + KERNEL_R2_EPS));
+	int count = 0, k = 0;
+	for (; k + 4 <= n; k += 4)
+	{
+		__m256d dx = _mm256_sub_pd(_mm256_loadu_pd(x + k), ox);
+		__m256d dy = _mm256_sub_pd(_mm256_loadu_pd(y + k), oy);
+		__m256d d2 = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+		int inMask = _mm256_movemask_pd(_mm256_cmp_pd(d2, lo, _CMP_LT_OQ));
+		int bandMask = _mm256_movemask_pd(_mm256_cmp_pd(d2, hi, _CMP_LT_OQ)) & ~inMask;
+		for (int mask = inMask | bandMask; mask != 0; mask &= mask - 1)
+		{
+			int l = __builtin_ctz(mask);
+			if ((inMask >> l & 1) || math::dist(x[k+l], y[k+l], O) < R)
+				selected[count++] = k + l;
+		}
+	}
+	int tail = _selectInDiscScalar(x + k, y + k, n - k, O, R, selected + count);
+	for (int t = count; t < count + tail; ++t)
+		selected[t] += k;
+	return count + tail;
+}
+
+/** every 4 points are loaded once and tested against all centers while they stay in registers. */
+__attribute__((target("avx2")))
+static void _countInDiscsAVX2(const double *x, const double *y, int n, const Point *O, int centerNum, double R, int *counts)
+{
+	__m256d lo = _mm256_set1_pd(R*R*(1 - KERNEL_R2_EPS)), hi = _mm256_set1_pd(R*R*(1 + KERNEL_R2_EPS));
+	int k = 0;
+	for (; k + 4 <= n; k += 4)
+	{
+		__m256d px = _mm256_loadu_pd(x + k), py = _mm256_loadu_pd(y + k);
+		for (int c = 0; c < centerNum; ++c)
+		{
+			__m256d dx = _mm256_sub_pd(px, _mm256_set1_pd(O[c].x));
+			__m256d dy = _mm256_sub_pd(py, _mm256_set1_pd(O[c].y));
+			__m256d d2 = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+			int inMask = _mm256_movemask_pd(_mm256_cmp_pd(d2, lo, _CMP_LT_OQ));
+			int bandMask = _mm256_movemask_pd(_mm256_cmp_pd(d2, hi, _CMP_LT_OQ)) & ~inMask;
+			counts[c] += __builtin_popcount(inMask);
+			for (; bandMask != 0; bandMask &= bandMask - 1)
+			{
+				int l = __builtin_ctz(bandMask);
+				if (math::dist(x[k+l], y[k+l], O[c]) < R)
+					++counts[c];
+			}
+		}
+	}
+	_countInDiscsScalar(x + k, y + k, n - k, O, centerNum, R, counts);
+}
+
+static bool _useAVX2()
+{
+	static const bool supported = __builtin_cpu_supports("avx2");
+	return supported;
+}
+#else
+static bool _useAVX2() { return false; }
+#endif
+
+int countInDisc(const double *x, const double *y, int n, const Point& O, double R)
+{
+#if KERNEL_HAS_AVX2
+	if (_useAVX2())
+		return _countInDiscAVX2(x, y, n, O, R);
+#endif
+	return _countInDiscScalar(x, y, n, O, R);
+}
+
+int selectInDisc(const double *x, const double *y, int n, const Point& O, double R, int *selected)
+{
+#if KERNEL_HAS_AVX2
+	if (_useAVX2())
+		return _selectInDiscAVX2(x, y, n, O, R, selected);
+#endif
+	return _selectInDiscScalar(x, y, n, O, R, selected);
+}
+
+void countInDiscs(const double *x, const double *y, int n, const Point *O, int centerNum, double R, int *counts)
+{
+#if KERNEL_HAS_AVX2
+	if (_useAVX2())
+		return _countInDiscsAVX2(x, y, n, O, centerNum, R, counts);
+#endif
+	_countInDiscsScalar(x, y, n, O, centerNum, R, counts);
+}
+
+const char* path()
+{
+	return _useAVX2() ? "avx2" : "scalar";
+}
+
+}
@@ -0,0 +1,45 @@
+//
+// Copyright (C) 2017-2018 Xu Le <xmutongxinXuLe@163.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#ifndef __KERNEL_H__
+#define __KERNEL_H__
+
+#include "Utils.h"
+
+/**
+ * point-in-disc kernels over contiguous coordinate arrays. A point is in the disc if math::dist(x, y, O) < R,
+ * the vectorized path compares squared distances and falls back to math::dist only for points whose squared
+ * distance is too close to R^2 to decide, so all paths agree exactly. The AVX2 path is chosen at runtime.
+ */
+namespace kernel {
+
+/** number of points k in [0, n) in the disc of center O and radius R. */
+int countInDisc(const double *x, const double *y, int n, const Point& O, double R);
+
+/** write offsets k in [0, n) of points in the disc to selected in increasing order, return their number. */
+int selectInDisc(const double *x, const double *y, int n, const Point& O, double R, int *selected);
+
+/** add the number of points k in [0, n) in the disc of center O[c] and radius R to counts[c], for c in [0, centerNum). */
+void countInDiscs(const double *x, const double *y, int n, const Point *O, int centerNum, double R, int *counts);
+
+/** name of the path in use, "avx2" or "scalar". */
+const char* path();
+
+}
+
+#endif /* __KERNEL_H__ */
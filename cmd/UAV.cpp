@@ -20,10 +20,6 @@
 
 extern int log_level;
 
-extern Point *groundUsers;
-extern double *rateTable;
-extern int *servedTable;
-
 double UAV::theta = 0.7407;    // 42.44 degree
 double UAV::sensitivity = -94.0; // -94dBm, see Table 7.3.3-1 of 3GPP TS 36.521-1 V14.4.0 (2017-09)
 double UAV::TNPSD = -174.0;    // thermal noise power spectrum density: -174dBm/Hz
@@ -39,77 +35,108 @@ std::vector<double> UAV::radiusTable;
 std::vector<double> UAV::powerTable;
 std::vector<std::vector<double> > UAV::snrTable;
 
-UAV::UAV(int _band) : band(-1), type(-1), B(0.0)
+UAV::UAV(ScenarioContext& _context, int _band) : context(&_context), band(-1), type(-1), B(0.0)
 {
+	disc.attach(&context->discSlot);
 	setBand(_band);
 }
 
 UAV::~UAV()
 {
-	for (itU = users.begin(); itU != users.end(); ++itU)
-		servedTable[itU->first] = 0;
+	for (size_t k = 0; k < users.size(); ++k)
+		context->servedTable.reset(users[k]);
 	users.clear();
 }
 
 bool UAV::served(int user)
 {
-	return users.find(user) != users.end();
+	if (!context->servedTable.test(user))
+		return false;
+	size_t slot = static_cast<size_t>(context->userSlot[user]);
+	return slot < users.size() && users[slot] == user;
 }
 
 int UAV::serve(int user)
 {
-	if (servedTable[user] == 1)
+	if (context->servedTable.test(user))
 		return Status::ALREADY;
-	if (math::dist(pos, groundUsers[user]) > R)
+	if (math::dist(pos, context->groundUsers[user]) > R)
 		return Status::OUT;
-	double bwReq = 180.0 * vrbTable[type][0]; // 180kHz
-	users.insert(std::pair<int, double>(user, bwReq));
-	B += bwReq;
-	servedTable[user] = 1;
+	context->userSlot[user] = static_cast<int>(users.size());
+	users.push_back(user);
+	B += userBandwidth();
+	context->servedTable.set(user);
+	disc.add(&context->groundUsers[user], user);
 	// debug_log("serve user [%d], now B is %f\n", user, B);
 	return Status::OK;
 }
 
-int UAV::unserve(int user)
+/** serve users of batch that are unserved and in range in one pass, return the number of users served. */
+int UAV::serve(const int *batch, int n)
 {
-	if ((itU = users.find(user)) != users.end())
+	size_t oldNum = users.size();
+	for (int k = 0; k < n; ++k)
 	{
-		B -= itU->second;
-		servedTable[user] = 0;
-		// debug_log("unserve user [%d], now B is %f\n", user, B);
-		users.erase(itU);
-		return Status::OK;
+		int user = batch[k];
+		if (context->servedTable.test(user) || math::dist(pos, context->groundUsers[user]) > R)
+			continue;
+		context->userSlot[user] = static_cast<int>(users.size());
+		users.push_back(user);
+		B += userBandwidth();
+		context->servedTable.set(user);
+		disc.add(&context->groundUsers[user], user);
 	}
-	return Status::NOTEXIST;
+	return static_cast<int>(users.size() - oldNum);
 }
 
-void UAV::adjust()
+int UAV::unserve(int user)
 {
-	std::vector<Point*> usersPos(users.size(), NULL);
-	itU = users.begin();
-	for (size_t k = 0; itU != users.end(); ++itU)
-		usersPos[k++] = &groundUsers[itU->first];
-	disc.initialize(usersPos.begin(), usersPos.end());
-	disc.cover();
+	if (!served(user))
+		return Status::NOTEXIST;
+	B -= userBandwidth();
+	context->servedTable.reset(user);
+	disc.remove(user);
+	// debug_log("unserve user [%d], now B is %f\n", user, B);
+	// the last user takes the slot of the unserved one
+	int slot = context->userSlot[user];
+	users[slot] = users.back();
+	context->userSlot[users[slot]] = slot;
+	users.pop_back();
+	return Status::OK;
+}
+
+void UAV::adjust(Random& random)
+{
+	if (users.empty())
+		return;
+	disc.update(random);
 	setR(disc.r);
 	pos.x = disc.O.x;
 	pos.y = disc.O.y;
 }
 
+/** unserve the users out of range, which are reported in increasing order of IDs. */
 void UAV::check(std::vector<int>& erased)
 {
 	erased.clear();
-	for (itU = users.begin(); itU != users.end();)
+	size_t kept = 0;
+	for (size_t k = 0; k < users.size(); ++k)
 	{
-		if (math::dist(pos, groundUsers[itU->first]) > R)
+		if (math::dist(pos, context->groundUsers[users[k]]) > R)
+			erased.push_back(users[k]);
+		else
 		{
-			B -= itU->second;
-			servedTable[itU->first] = 0;
-			erased.push_back(itU->first);
-			itU = users.erase(itU);
+			context->userSlot[users[k]] = static_cast<int>(kept);
+			users[kept++] = users[k];
 		}
-		else
-			++itU;
+	}
+	users.resize(kept);
+	std::sort(erased.begin(), erased.end());
+	for (size_t k = 0; k < erased.size(); ++k)
+	{
+		B -= userBandwidth();
+		context->servedTable.reset(erased[k]);
+		disc.remove(erased[k]);
 	}
 }
 
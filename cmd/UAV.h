@@ -35,7 +35,7 @@ enum Band {
 class UAV
 {
 public:
-	explicit UAV(int _band);
+	UAV(ScenarioContext& _context, int _band);
 	~UAV();
 
 	enum Status {
@@ -50,9 +50,10 @@ public:
 
 	bool served(int user);
 	int serve(int user);
+	int serve(const int *batch, int n);
 	int unserve(int user);
 
-	void adjust();
+	void adjust(Random& random);
 	void check(std::vector<int>& erased);
 
 	double getX() { return pos.x; }
@@ -65,6 +66,7 @@ public:
 	double getTotalB() { return totalB[type]; }
 	double getTotalC() { return totalC[type]; }
 	int getMaxU() { return UAV::maxU[type]; }
+	double userBandwidth() { return 180.0 * vrbTable[type][0]; } // 180kHz
 	int getBand() { return band; }
 	int getType() { return type; }
 	int userNum() { return static_cast<int>(users.size()); }
@@ -77,15 +79,15 @@ public:
 	void setPos(const Point& _pos) { pos.x = _pos.x; pos.y = _pos.y; }
 
 private:
+	ScenarioContext *context; ///< the case whose users this UAV serves.
 	int band;  ///< which band a UAV operates on.
 	int type;  ///< band type of a UAV.
 	Point pos; ///< 3D position.
 	double R;  ///< coverage radius.
 	double P;  ///< transmit power.
 	double B;  ///< occupied bandwidth.
-	std::map<int, double> users;  ///< users served by this UAV, map from user ID to its occupied bandwidth.
-	std::map<int, double>::iterator itU; ///< iterator used to handle with container users.
-	Disc disc; ///< min cover disc of users.
+	std::vector<int> users; ///< IDs of users served by this UAV in no particular order, each occupies userBandwidth(), see ScenarioContext::userSlot.
+	Disc disc; ///< min cover disc of users, kept up to date as users are served and unserved.
 
 public:
 	static double theta;  ///< optimal elevation angle depends only on the environment.
@@ -118,7 +120,7 @@ private:
 	char buf[100];
 };
 
-/** configure static members of class UAV. */
+/** configure static members of class UAV, once before any case is solved, they are only read afterwards. */
 void configureUAV();
 
 #endif /* __UAV_H__ */
@@ -16,16 +16,37 @@
 // Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 //
 
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "Utils.h"
+#include "CaseFile.h"
 
 extern int log_level;
 
-extern int numUser;
-extern double gX;
-extern double gY;
-extern Point *groundUsers;
-extern double *rateTable;
-extern int *servedTable;
+#ifdef COUNT_ALLOCATIONS
+std::atomic<long> allocationCount(0);
+
+void* operator new(size_t size)
+{
+	++allocationCount;
+	void *p = malloc(size == 0 ? 1 : size);
+	if (p == NULL)
+		throw std::bad_alloc();
+	return p;
+}
+
+void operator delete(void *p) noexcept
+{
+	free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+	free(p);
+}
+#endif
 
 namespace math {
 
@@ -49,6 +70,11 @@ double dist(const Point& A, const Point& B)
 	return sqrt((A.x - B.x)*(A.x - B.x) + (A.y - B.y)*(A.y - B.y));
 }
 
+double dist(double Ax, double Ay, const Point& B)
+{
+	return sqrt((Ax - B.x)*(Ax - B.x) + (Ay - B.y)*(Ay - B.y));
+}
+
 double dist2(const Point& A, const Point& B)
 {
 	return (A.x - B.x)*(A.x - B.x) + (A.y - B.y)*(A.y - B.y);
@@ -278,41 +304,53 @@ Point circleCircleCircle(const Point& A, const Point& B, const Point& C, double
 
 }
 
-bool Disc::add(Point *user)
+bool Disc::add(Point *point, int id)
 {
-	Point U = *user;
-	if (math::dist2(O, U) > r2)
-	{
-		points.push_back(user);
-		_minDiscWithPoint(U, static_cast<int>(points.size())-2);
-		r = sqrt(r2);
-		return true;
-	}
-	return false;
+	(*slotOf)[id] = static_cast<int>(points.size());
+	points.push_back(point);
+	ids.push_back(id);
+	if (!stale && math::dist2(O, *point) > r2)
+		stale = true;
+	return stale;
 }
 
-bool Disc::remove(Point *user)
+bool Disc::remove(int id)
 {
-	if (math::equal0(math::dist2(O, *user) - r2))
-	{
-		points.erase(std::remove(points.begin(), points.end(), user), points.end());
-		cover();
-		return true;
-	}
-	return false;
+	int slot = (*slotOf)[id];
+	if (slot < 0 || slot >= static_cast<int>(ids.size()) || ids[slot] != id)
+		return false;
+	Point *point = points[slot];
+	points[slot] = points.back();
+	ids[slot] = ids.back();
+	(*slotOf)[ids[slot]] = slot;
+	points.pop_back();
+	ids.pop_back();
+	(*slotOf)[id] = -1;
+	if (!stale && math::dist2(O, *point) >= r2*(1 - 1e-9)) // precision consideration, a support point leaves
+		stale = true;
+	return stale;
 }
 
-void Disc::cover()
+void Disc::cover(Random& random)
 {
-	if (points.size() < 3)
+	stale = false;
+	if (points.empty())
 	{
-		error_log("points number less than 3!\n");
-		exit(EXIT_FAILURE);
+		r = 0.0;
+		r2 = -1.0;
+		return;
 	}
 
-	std::random_shuffle(points.begin(), points.end());
+	for (int k = static_cast<int>(points.size())-1; k > 0; --k)
+	{
+		int l = random.below(k+1);
+		std::swap(points[k], points[l]);
+		std::swap(ids[k], ids[l]);
+	}
+	for (size_t k = 0; k < ids.size(); ++k)
+		(*slotOf)[ids[k]] = static_cast<int>(k);
 
-	__segmentMidpoint(*points[0], *points[1]);
+	__segmentMidpoint(*points[0], *points[std::min<size_t>(1, points.size()-1)]);
 
 	int n = static_cast<int>(points.size());
 	for (int i = 2; i < n; ++i)
@@ -416,33 +454,516 @@ void ConvexHull::_sortPoints()
 			printf("i: %lu, x: %f, y: %f\n", i, points[i]->x, points[i]->y);
 }
 
-int parseInput(const char *filename)
+void BucketGrid::initialize(int _xNum, int _yNum, int granularity, const Point *_users, int userNum)
 {
-	FILE *fd = fopen(filename, "r");
-	if (fd == NULL)
+	xNum = _xNum;
+	yNum = _yNum;
+	users = _users;
+	start.assign(xNum*yNum + 1, 0);
+	cellOf.resize(userNum);
+	for (int i = 0; i < userNum; ++i)
 	{
-		error_log("Fail to open file %s.\n", filename);
+		int _xIdx = static_cast<int>(users[i].x) / granularity;
+		int _yIdx = static_cast<int>(users[i].y) / granularity;
+		cellOf[i] = _xIdx*yNum + _yIdx;
+		++start[cellOf[i] + 1];
+	}
+	for (int c = 0; c < xNum*yNum; ++c)
+		start[c+1] += start[c];
+	live.assign(xNum*yNum, 0);
+	id.resize(userNum);
+	x.resize(userNum);
+	y.resize(userNum);
+	slotOf.resize(userNum);
+	for (int i = 0; i < userNum; ++i)
+	{
+		int c = cellOf[i], slot = start[c] + live[c];
+		id[slot] = i;
+		x[slot] = users[i].x;
+		y[slot] = users[i].y;
+		slotOf[i] = slot;
+		++live[c];
+	}
+}
+
+void BucketGrid::insert(int user)
+{
+	int c = cellOf[user], firstDead = start[c] + live[c];
+	assert(slotOf[user] >= firstDead);
+	_swap(slotOf[user], firstDead);
+	x[firstDead] = users[user].x;
+	y[firstDead] = users[user].y;
+	++live[c];
+}
+
+void BucketGrid::remove(int user)
+{
+	int c = cellOf[user], lastLive = start[c] + live[c] - 1;
+	assert(slotOf[user] <= lastLive);
+	_swap(slotOf[user], lastLive);
+	x[lastLive] = y[lastLive] = 1e100;
+	--live[c];
+}
+
+void BucketGrid::_swap(int slot1, int slot2)
+{
+	std::swap(id[slot1], id[slot2]);
+	std::swap(x[slot1], x[slot2]);
+	std::swap(y[slot1], y[slot2]);
+	slotOf[id[slot1]] = slot1;
+	slotOf[id[slot2]] = slot2;
+}
+
+void DiscIndex::initialize(double width, double height, double _granularity)
+{
+	granularity = _granularity;
+	xNum = static_cast<int>(ceil(width/granularity)) + 1;
+	yNum = static_cast<int>(ceil(height/granularity)) + 1;
+	maxR = 0.0;
+	cells.assign(xNum*yNum, std::vector<int>());
+	cellOf.clear();
+	pos.clear();
+	radius.clear();
+	bandOf.clear();
+}
+
+void DiscIndex::update(int idx, const Point& O, double R, int band)
+{
+	int c = _cell(O.x, xNum)*yNum + _cell(O.y, yNum);
+	if (idx == static_cast<int>(pos.size()))
+	{
+		cellOf.push_back(c);
+		pos.push_back(O);
+		radius.push_back(R);
+		bandOf.push_back(band);
+		cells[c].push_back(idx);
+	}
+	else
+	{
+		if (cellOf[idx] != c)
+		{
+			vectorRemove(cells[cellOf[idx]], idx);
+			cells[c].push_back(idx);
+			cellOf[idx] = c;
+		}
+		pos[idx] = O;
+		radius[idx] = R;
+		bandOf[idx] = band;
+	}
+	if (maxR < R)
+		maxR = R;
+}
+
+void DiscIndex::query(const Point& O, double r, std::vector<int>& result, int band, double scale)
+{
+	double reach = scale*(r + maxR) + 1.0;
+	int mBegin = _cell(O.x - reach, xNum), mEnd = _cell(O.x + reach, xNum);
+	int nBegin = _cell(O.y - reach, yNum), nEnd = _cell(O.y + reach, yNum);
+	result.clear();
+	for (int m = mBegin; m <= mEnd; ++m)
+	{
+		for (int n = nBegin; n <= nEnd; ++n)
+		{
+			std::vector<int>& cell = cells[m*yNum + n];
+			for (size_t k = 0; k < cell.size(); ++k)
+			{
+				int idx = cell[k];
+				if ((band < 0 || bandOf[idx] == band) && math::dist(O, pos[idx]) < scale*(r + radius[idx]) + 1.0)
+					result.push_back(idx);
+			}
+		}
+	}
+	std::sort(result.begin(), result.end());
+}
+
+int DiscIndex::_cell(double coord, int num)
+{
+	if (coord < 0.0)
+		return 0;
+	return std::min(static_cast<int>(coord/granularity), num-1);
+}
+
+int BitSet::count(int begin, int end) const
+{
+	if (begin >= end)
+		return 0;
+	int first = begin >> 6, last = (end - 1) >> 6;
+	uint64_t headMask = ~static_cast<uint64_t>(0) << (begin & 63), tailMask = ~static_cast<uint64_t>(0) >> (63 - ((end - 1) & 63));
+	if (first == last)
+		return __builtin_popcountll(words[first] & headMask & tailMask);
+	int bits = __builtin_popcountll(words[first] & headMask) + __builtin_popcountll(words[last] & tailMask);
+	for (int w = first + 1; w < last; ++w)
+		bits += __builtin_popcountll(words[w]);
+	return bits;
+}
+
+void TournamentTree::initialize(const std::vector<int>& _keys)
+{
+	keys = _keys;
+	leafNum = 1;
+	while (leafNum < static_cast<int>(keys.size()))
+		leafNum <<= 1;
+	tree.assign(2*leafNum, -1);
+	for (int idx = 0; idx < static_cast<int>(keys.size()); ++idx)
+		tree[leafNum + idx] = idx;
+	for (int p = leafNum - 1; p >= 1; --p)
+		tree[p] = _winner(tree[2*p], tree[2*p+1]);
+}
+
+void TournamentTree::update(int idx, int key)
+{
+	keys[idx] = key;
+	for (int p = (leafNum + idx) / 2; p >= 1; p /= 2)
+		tree[p] = _winner(tree[2*p], tree[2*p+1]);
+}
+
+int TournamentTree::_winner(int lhs, int rhs)
+{
+	if (lhs < 0)
+		return rhs;
+	if (rhs < 0)
+		return lhs;
+	return keys[rhs] > keys[lhs] ? rhs : lhs; // indices in left subtree are always smaller
+}
+
+void ScenarioContext::release()
+{
+	if (mapped != NULL)
+		munmap(mapped, mappedSize);
+	else
+	{
+		delete []groundUsers;
+		delete []rateTable;
+	}
+	mapped = NULL;
+	mappedSize = 0;
+	groundUsers = NULL;
+	rateTable = NULL;
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (size_t t = 0; t < workers.size(); ++t)
+		workers[t].join();
+}
+
+void ThreadPool::_run(int n, int threadNum, void (*_task)(void*, int, int), void *arg)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		// a new worker starts waiting for the task posted next
+		while (static_cast<int>(workers.size()) < threadNum - 1)
+			workers.push_back(std::thread(&ThreadPool::_work, this, static_cast<int>(workers.size()) + 1, generation));
+		task = _task;
+		taskArg = arg;
+		taskN = n;
+		taskThreads = threadNum;
+		next = 0;
+		pending = threadNum - 1;
+		++generation;
+	}
+	wake.notify_all();
+	_drain(0);
+	std::unique_lock<std::mutex> lock(mutex);
+	idle.wait(lock, [this]() { return pending == 0; });
+	task = NULL;
+	taskArg = NULL;
+}
+
+void ThreadPool::_work(int t, unsigned seen)
+{
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [this, seen]() { return stopping || generation != seen; });
+			if (stopping)
+				return;
+			seen = generation;
+			if (t >= taskThreads)
+				continue;
+		}
+		_drain(t);
+		std::lock_guard<std::mutex> lock(mutex);
+		if (--pending == 0)
+			idle.notify_one();
+	}
+}
+
+void ThreadPool::_drain(int t)
+{
+	for (int k = next++; k < taskN; k = next++)
+		task(taskArg, t, k);
+}
+
+/** the longest number _parseNumber() hands over to strtod(). */
+#define PARSE_NUMBER_MAX_LEN    63
+
+/**
+ * parse the number at [p, end) into value and return the position after it, or NULL if there is no number.
+ * Up to 15 significant digits with at most 22 decimals are converted by one exact division or multiplication,
+ * which rounds the same as strtod() does, other numbers are handed over to strtod().
+ */
+static const char* _parseNumber(const char *p, const char *end, double& value)
+{
+	static const double pow10[23] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+	const char *begin = p;
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+'))
+		negative = *p++ == '-';
+	uint64_t mantissa = 0;
+	int digits = 0, significant = 0, exponent = 0;
+	for (; p < end && *p >= '0' && *p <= '9'; ++p, ++digits)
+	{
+		mantissa = mantissa*10 + (*p - '0');
+		significant += mantissa != 0;
+	}
+	if (p < end && *p == '.')
+	{
+		for (++p; p < end && *p >= '0' && *p <= '9'; ++p, ++digits, --exponent)
+		{
+			mantissa = mantissa*10 + (*p - '0');
+			significant += mantissa != 0;
+		}
+	}
+	if (digits == 0)
+		return NULL;
+	if (significant <= 15 && exponent >= -22 && (p == end || (*p != 'e' && *p != 'E')))
+	{
+		value = exponent < 0 ? mantissa / pow10[-exponent] : static_cast<double>(mantissa);
+		if (negative)
+			value = -value;
+		return p;
+	}
+
+	char buf[PARSE_NUMBER_MAX_LEN + 1];
+	int len = 0;
+	for (p = begin; p < end && len < PARSE_NUMBER_MAX_LEN && strchr("+-.0123456789eE", *p) != NULL; ++p)
+		buf[len++] = *p;
+	buf[len] = '\0';
+	char *stop = NULL;
+	value = strtod(buf, &stop);
+	return begin + (stop - buf);
+}
+
+static const char* _skipBlank(const char *p, const char *end)
+{
+	while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+		++p;
+	return p;
+}
+
+/** number of lines of [p, end) that are not blank. */
+static int _countRows(const char *p, const char *end)
+{
+	int rows = 0;
+	while (p < end)
+	{
+		p = _skipBlank(p, end);
+		if (p < end && *p != '\n')
+			++rows;
+		const char *eol = static_cast<const char*>(memchr(p, '\n', end - p));
+		p = eol != NULL ? eol + 1 : end;
+	}
+	return rows;
+}
+
+/** parse the non-blank lines of [p, end) as users first, first+1, ..., each line is "x,y" or "x,y,rate". */
+static void _parseRows(const char *p, const char *end, int first, ScenarioContext& context, const char *filename)
+{
+	int i = first;
+	while ((p = _skipBlank(p, end)) < end)
+	{
+		if (*p == '\n')
+		{
+			++p;
+			continue;
+		}
+		double rate = 0.0;
+		bool valid = (p = _parseNumber(p, end, context.groundUsers[i].x)) != NULL && (p = _skipBlank(p, end)) < end && *p++ == ',' &&
+				(p = _parseNumber(_skipBlank(p, end), end, context.groundUsers[i].y)) != NULL;
+		if (valid && (p = _skipBlank(p, end)) < end && *p == ',')
+			valid = (p = _parseNumber(_skipBlank(p + 1, end), end, rate)) != NULL;
+		if (valid && (p = _skipBlank(p, end)) < end)
+			valid = *p++ == '\n';
+		if (!valid)
+		{
+			error_log("Invalid line of user %d in file %s.\n", i, filename);
+			exit(EXIT_FAILURE);
+		}
+		context.rateTable[i++] = rate;
+	}
+}
+
+static_assert(sizeof(Point) == CASE_RECORD_SIZE, "user records of binary case files must be laid out as class Point");
+
+/** use the users and data rates of a mapped binary case file in place, the mapping is kept by context. */
+static int _useBinaryCase(const char *filename, ScenarioContext& context, void *mapped, size_t size)
+{
+	const CaseHeader *header = static_cast<const CaseHeader*>(mapped);
+	if (header->version != CASE_VERSION || header->recordSize != sizeof(Point) || header->numUser < 0 || size != caseFileSize(header->numUser))
+	{
+		error_log("Unsupported or truncated binary case file %s.\n", filename);
 		exit(EXIT_FAILURE);
 	}
+	char *records = static_cast<char*>(mapped) + sizeof(CaseHeader);
+	context.mapped = mapped;
+	context.mappedSize = size;
+	context.gX = header->gX, context.gY = header->gY;
+	context.numUser = header->numUser;
+	context.groundUsers = reinterpret_cast<Point*>(records);
+	context.rateTable = reinterpret_cast<double*>(records + static_cast<size_t>(header->numUser) * sizeof(Point));
+	context.servedTable.assign(context.numUser);
+	context.discSlot.assign(context.numUser, -1);
+	context.userSlot.assign(context.numUser, -1);
+	uncond_log("map %s: %.2fMB, %d users, %s\n", filename, size / 1048576.0, context.numUser, header->flags & CASE_RATES ? "with data rates" : "no data rates");
+	return header->numAvailableUAV;
+}
 
-	int _x = 0, _y = 0, availableUAVNum = 0;
-	fscanf(fd, "%d,%d,%d,%d\n", &_x, &_y, &numUser, &availableUAVNum);
-	gX = _x, gY = _y;
+/**
+ * the case file is mapped into memory and parsed in place. With threadNum > 1, the users are split into chunks
+ * at line boundaries, the non-blank lines of every chunk are counted first to know the user each chunk starts
+ * with, then the chunks are parsed in parallel.
+ */
+int parseInput(const char *filename, ScenarioContext& context, int threadNum)
+{
+	Timer timer("parseInput(): ");
 
-	groundUsers = new Point[numUser];
-	rateTable = new double[numUser];
-	servedTable = new int[numUser];
-	for (int i = 0; i < numUser; ++i)
+	int fd = open(filename, O_RDONLY);
+	struct stat st;
+	if (fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0)
+	{
+		error_log("Fail to open file %s.\n", filename);
+		exit(EXIT_FAILURE);
+	}
+	size_t size = st.st_size;
+	void *mapped = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0); // writes would only touch private copies
+	close(fd);
+	if (mapped == MAP_FAILED)
 	{
-		fscanf(fd, "%lf,%lf,%lf\n", &groundUsers[i].x, &groundUsers[i].y, &rateTable[i]);
-		servedTable[i] = 0;
+		error_log("Fail to map file %s.\n", filename);
+		exit(EXIT_FAILURE);
 	}
+	context.release();
+	if (size >= sizeof(CaseHeader) && memcmp(mapped, CASE_MAGIC, 4) == 0)
+		return _useBinaryCase(filename, context, mapped, size);
+	madvise(mapped, size, MADV_SEQUENTIAL);
+	const char *begin = static_cast<const char*>(mapped), *end = begin + size;
+
+	double header[4];
+	const char *p = begin;
+	for (int k = 0; k < 4; ++k)
+	{
+		p = _parseNumber(_skipBlank(p, end), end, header[k]);
+		if (p == NULL || (p = _skipBlank(p, end)) == end || *p++ != (k < 3 ? ',' : '\n'))
+		{
+			error_log("Invalid header in file %s.\n", filename);
+			exit(EXIT_FAILURE);
+		}
+	}
+	context.gX = static_cast<int>(header[0]), context.gY = static_cast<int>(header[1]);
+	context.numUser = static_cast<int>(header[2]);
+	int availableUAVNum = static_cast<int>(header[3]);
+
+	context.groundUsers = new Point[context.numUser];
+	context.rateTable = new double[context.numUser];
+	context.servedTable.assign(context.numUser);
+	context.discSlot.assign(context.numUser, -1);
+	context.userSlot.assign(context.numUser, -1);
+
+	// chunk t covers [bounds[t], bounds[t+1]), each bound but the last is the beginning of a line
+	int chunkNum = std::max(std::min(threadNum, static_cast<int>((end - p) >> 20)), 1);
+	std::vector<const char*> bounds(chunkNum + 1, end);
+	bounds[0] = p;
+	for (int t = 1; t < chunkNum; ++t)
+	{
+		const char *eol = static_cast<const char*>(memchr(p + (end - p) * t / chunkNum, '\n', end - p - (end - p) * t / chunkNum));
+		bounds[t] = eol != NULL ? std::max(eol + 1, bounds[t-1]) : end;
+	}
+	std::vector<int> firstUser(chunkNum + 1, 0);
+	parallelFor(chunkNum, threadNum, [&bounds, &firstUser](int, int t) {
+		firstUser[t+1] = _countRows(bounds[t], bounds[t+1]);
+	});
+	for (int t = 0; t < chunkNum; ++t)
+		firstUser[t+1] += firstUser[t];
+	if (firstUser[chunkNum] != context.numUser)
+	{
+		error_log("File %s has %d users, %d expected.\n", filename, firstUser[chunkNum], context.numUser);
+		exit(EXIT_FAILURE);
+	}
+	parallelFor(chunkNum, threadNum, [&bounds, &firstUser, &context, filename](int, int t) {
+		_parseRows(bounds[t], bounds[t+1], firstUser[t], context, filename);
+	});
 
-	fclose(fd);
+	munmap(mapped, size);
+	double elapse = timer.elapsed();
+	uncond_log("parse %s: %.2fMB, %d users, %.1fMB/s\n", filename, size / 1048576.0, context.numUser, size / 1048576.0 / std::max(elapse, 1e-6));
 
 	return availableUAVNum;
 }
 
+void writeCase(const char *filename, const ScenarioContext& context, int availableUAVNum)
+{
+	CaseHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, CASE_MAGIC, 4);
+	header.version = CASE_VERSION;
+	header.recordSize = sizeof(Point);
+	header.gX = static_cast<int32_t>(context.gX), header.gY = static_cast<int32_t>(context.gY);
+	header.numUser = context.numUser;
+	header.numAvailableUAV = availableUAVNum;
+	for (int i = 0; i < context.numUser && header.flags == 0; ++i)
+		if (context.rateTable[i] != 0.0)
+			header.flags = CASE_RATES;
+	std::vector<Point> records(context.groundUsers, context.groundUsers + context.numUser);
+	for (size_t i = 0; i < records.size(); ++i)
+		records[i].z = 0.0;
+	header.checksum = caseChecksum(records.data(), records.size() * sizeof(Point));
+	header.checksum = caseChecksum(context.rateTable, context.numUser * sizeof(double), header.checksum);
+
+	// written to a temporary file first and renamed, so no truncated case file is left behind
+	std::string tmpFile(filename);
+	tmpFile += ".tmp";
+	FILE *fd = fopen(tmpFile.c_str(), "wb");
+	if (fd == NULL)
+	{
+		error_log("Fail to open file %s.\n", tmpFile.c_str());
+		exit(EXIT_FAILURE);
+	}
+	bool written = fwrite(&header, sizeof(header), 1, fd) == 1 && fwrite(records.data(), sizeof(Point), records.size(), fd) == records.size() &&
+			fwrite(context.rateTable, sizeof(double), context.numUser, fd) == static_cast<size_t>(context.numUser);
+	if (fclose(fd) != 0 || !written)
+	{
+		remove(tmpFile.c_str());
+		error_log("Fail to write file %s.\n", tmpFile.c_str());
+		exit(EXIT_FAILURE);
+	}
+	if (rename(tmpFile.c_str(), filename) != 0)
+	{
+		remove(tmpFile.c_str());
+		error_log("Fail to rename %s to %s.\n", tmpFile.c_str(), filename);
+		exit(EXIT_FAILURE);
+	}
+}
+
+bool verifyCase(const char *filename)
+{
+	ScenarioContext context;
+	parseInput(filename, context);
+	if (context.mapped == NULL)
+		return true;
+	const CaseHeader *header = static_cast<const CaseHeader*>(context.mapped);
+	size_t size = context.mappedSize - sizeof(CaseHeader);
+	return caseChecksum(static_cast<const char*>(context.mapped) + sizeof(CaseHeader), size) == header->checksum;
+}
+
 bool vectorFind(std::vector<int>& vec, const int key)
 {
 	return std::find(vec.begin(), vec.end(), key) != vec.end();
@@ -31,6 +31,10 @@
 #include <map>
 #include <algorithm>
 #include <utility>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 
 #include "Timer.h"
 
@@ -55,6 +59,8 @@ double dBm2mW(double dBm);
 
 double dist(const Point& A, const Point& B);
 
+double dist(double Ax, double Ay, const Point& B);
+
 double dist2(const Point& A, const Point& B);
 
 double dist3D(const Point& A, const Point& B);
@@ -75,15 +81,43 @@ Point circleCircleCircle(const Point& A, const Point& B, const Point& C, double
 
 }
 
+/** xorshift64* pseudo random number generator, the same seed gives the same sequence on every platform. */
+class Random
+{
+public:
+	explicit Random(uint64_t _seed = 1) { seed(_seed); }
+
+	void seed(uint64_t _seed) { state = _seed != 0 ? _seed : 0x9E3779B97F4A7C15ULL; }
+	uint64_t next()
+	{
+		state ^= state >> 12;
+		state ^= state << 25;
+		state ^= state >> 27;
+		return state * 0x2545F4914F6CDD1DULL;
+	}
+	int below(int n) { return static_cast<int>(next() % static_cast<uint64_t>(n)); } ///< uniform in [0, n).
+
+private:
+	uint64_t state;
+};
+
+/**
+ * min cover disc of a set of points. add() and remove() keep track of whether the disc is still valid: adding a
+ * point inside the disc or removing a point off its boundary leaves it valid in O(1), otherwise the disc is
+ * marked stale and update() recomputes it by cover() once, however many changes were made in between.
+ * Points are identified by IDs, and slotOf[id] tracks where each point is held, so remove() is a swap in O(1).
+ * An ID must be held by at most one disc sharing slotOf at a time.
+ */
 class Disc
 {
 public:
-	template <class _InputIter>
-	void initialize(_InputIter _first, _InputIter _last);
+	Disc() : r(0.0), r2(-1.0), stale(false), slotOf(NULL) {}
 
-	bool add(Point *user);
-	bool remove(Point *user);
-	void cover();
+	void attach(std::vector<int> *_slotOf) { slotOf = _slotOf; } ///< slotOf must cover every ID added.
+	bool add(Point *point, int id);
+	bool remove(int id);
+	void cover(Random& random);
+	void update(Random& random) { if (stale) cover(random); }
 	size_t size() { return points.size(); }
 
 private:
@@ -97,15 +131,12 @@ public:
 
 private:
 	double r2; // r^2, for efficiency
+	bool stale; // a point was added outside the disc or a support point was removed since the last cover()
 	std::vector<Point*> points;
+	std::vector<int> ids; ///< ID of each point of points.
+	std::vector<int> *slotOf; ///< map from ID to its index in points.
 };
 
-template <class _InputIter>
-void Disc::initialize(_InputIter _first, _InputIter _last)
-{
-	points.assign(_first, _last);
-}
-
 class ConvexHull
 {
 public:
@@ -129,7 +160,225 @@ void ConvexHull::initialize(_InputIter _first, _InputIter _last)
 	points.assign(_first, _last);
 }
 
-int parseInput(const char *filename);
+/**
+ * users bucketed by cells of granularity x granularity, stored as arrays of slots sorted by cell (row-major, y inner),
+ * so users of neighbouring cells are contiguous in memory. Live users of a cell occupy the front of its slots,
+ * and removing or re-inserting a user is a swap of two slots. Dead slots hold coordinates far outside any map,
+ * so a strip of cells [nBegin, nEnd) in column m can be scanned as a whole from stripBegin() to stripEnd().
+ */
+class BucketGrid
+{
+public:
+	void initialize(int _xNum, int _yNum, int granularity, const Point *users, int userNum);
+	void insert(int user);
+	void remove(int user);
+	int size(int m, int n) { return live[m*yNum + n]; }
+	int begin(int m, int n) { return start[m*yNum + n]; }
+	int end(int m, int n) { return start[m*yNum + n] + live[m*yNum + n]; }
+	int stripBegin(int m, int nBegin) { return start[m*yNum + nBegin]; }
+	int stripEnd(int m, int nEnd) { return start[m*yNum + nEnd]; }
+	int slot(int user) { return slotOf[user]; } ///< live while user is in the grid, dead (coordinates 1e100) after remove().
+
+private:
+	void _swap(int slot1, int slot2);
+
+public:
+	std::vector<int> id;   ///< user ID of each slot, the permutation back to input order.
+	std::vector<double> x; ///< x coordinate of the user of each slot.
+	std::vector<double> y; ///< y coordinate of the user of each slot.
+
+private:
+	int xNum;
+	int yNum;
+	const Point *users;
+	std::vector<int> start;  ///< first slot of each cell, start[m*yNum + n].
+	std::vector<int> live;   ///< number of live users of each cell.
+	std::vector<int> slotOf; ///< map from user ID to its slot.
+	std::vector<int> cellOf; ///< map from user ID to its cell.
+};
+
+/**
+ * discs of UAVs bucketed by the cell of their centers, the cell size is the largest radius a disc can have.
+ * query() returns in increasing index the discs whose centers are closer than scale*(r + R) to O, where R is
+ * the radius of each disc, plus discs within 1 meter beyond that, so callers apply their own exact test.
+ */
+class DiscIndex
+{
+public:
+	void initialize(double width, double height, double granularity);
+	void update(int idx, const Point& O, double R, int band);
+	void query(const Point& O, double r, std::vector<int>& result, int band = -1, double scale = 1.0);
+	size_t size() { return pos.size(); }
+
+private:
+	int _cell(double coord, int num);
+
+private:
+	int xNum;
+	int yNum;
+	double granularity;
+	double maxR; ///< the largest radius ever updated.
+	std::vector<std::vector<int> > cells; ///< indices of discs in each cell, cells[m*yNum + n].
+	std::vector<int> cellOf;
+	std::vector<Point> pos;
+	std::vector<double> radius;
+	std::vector<int> bandOf;
+};
+
+/** packed bits of 64-bit words, such as the served flag of every user. */
+class BitSet
+{
+public:
+	BitSet() : bitNum(0) {}
+
+	void assign(int n) { bitNum = n; words.assign((n + 63) / 64, 0); }
+	void clear() { bitNum = 0; std::vector<uint64_t>().swap(words); }
+	bool test(int i) const { return (words[i >> 6] >> (i & 63) & 1) != 0; }
+	void set(int i) { words[i >> 6] |= static_cast<uint64_t>(1) << (i & 63); }
+	void reset(int i) { words[i >> 6] &= ~(static_cast<uint64_t>(1) << (i & 63)); }
+	int count(int begin, int end) const;
+	int count() const { return count(0, bitNum); }
+	int size() const { return bitNum; }
+
+private:
+	int bitNum;
+	std::vector<uint64_t> words;
+};
+
+/**
+ * one case to solve: the size of the map, the ground users with their data rates and which of them are served.
+ * A Solution and its UAVs change no state outside their context, so contexts of different cases can be solved on
+ * different threads at once. The radio tables of class UAV are set up once by configureUAV() and shared read-only.
+ */
+class ScenarioContext
+{
+public:
+	ScenarioContext() : gX(0.0), gY(0.0), numUser(0), groundUsers(NULL), rateTable(NULL), mapped(NULL), mappedSize(0) {}
+	~ScenarioContext() { release(); }
+
+	void release(); ///< free the users and data rates, or unmap them if they are used in place.
+
+private:
+	ScenarioContext(const ScenarioContext&);
+	ScenarioContext& operator=(const ScenarioContext&);
+
+public:
+	double gX; ///< width of the map, measured in meter.
+	double gY; ///< height of the map, measured in meter.
+	int numUser;
+	Point *groundUsers;
+	double *rateTable;
+	BitSet servedTable; ///< whether each user is served by some UAV.
+	std::vector<int> discSlot; ///< slot of each served user in the Disc of the UAV serving it, see Disc::attach().
+	std::vector<int> userSlot; ///< position of each served user in the users of the UAV serving it.
+	void *mapped;      ///< the binary case file groundUsers and rateTable point into, NULL if they are allocated.
+	size_t mappedSize;
+};
+
+/** winner tree over integer keys, the winner is the largest key, ties go to the smaller index. */
+class TournamentTree
+{
+public:
+	void initialize(const std::vector<int>& _keys);
+	void update(int idx, int key);
+	int top() { return tree[1]; }
+	int key(int idx) { return keys[idx]; }
+
+private:
+	int _winner(int lhs, int rhs);
+
+private:
+	int leafNum;
+	std::vector<int> keys;
+	std::vector<int> tree; ///< tree[1] is the root, tree[leafNum + idx] is the leaf of idx, -1 means empty leaf.
+};
+
+/**
+ * call func(t, k) for every k in [0, n) on threadNum threads, t is the thread number in [0, threadNum).
+ * k is handed out in increasing order, so each thread sees its own k in increasing order as well.
+ */
+template <class _Func>
+void parallelFor(int n, int threadNum, _Func func)
+{
+	if (threadNum <= 1)
+	{
+		for (int k = 0; k < n; ++k)
+			func(0, k);
+		return;
+	}
+
+	std::atomic<int> next(0);
+	std::vector<std::thread> workers;
+	workers.reserve(threadNum);
+	for (int t = 0; t < threadNum; ++t)
+		workers.push_back(std::thread([t, n, &next, &func]() {
+			for (int k = next++; k < n; k = next++)
+				func(t, k);
+		}));
+	for (int t = 0; t < threadNum; ++t)
+		workers[t].join();
+}
+
+/**
+ * threads kept alive across calls of run(), so that the short parallel loops repeated by Solution do not spawn
+ * threads every time. The caller of run() works as thread 0, run() must not be called by several threads at once.
+ */
+class ThreadPool
+{
+public:
+	ThreadPool() : task(NULL), taskArg(NULL), taskN(0), taskThreads(0), next(0), generation(0), pending(0), stopping(false) {}
+	~ThreadPool();
+
+	/** the same as parallelFor(n, threadNum, func), workers are spawned when threadNum exceeds the pool first. */
+	template <class _Func>
+	void run(int n, int threadNum, _Func func)
+	{
+		if (threadNum <= 1 || n <= 1)
+		{
+			for (int k = 0; k < n; ++k)
+				func(0, k);
+			return;
+		}
+		_run(n, threadNum, &_invoke<_Func>, &func);
+	}
+
+private:
+	ThreadPool(const ThreadPool&);
+	ThreadPool& operator=(const ThreadPool&);
+
+	template <class _Func>
+	static void _invoke(void *func, int t, int k) { (*static_cast<_Func*>(func))(t, k); }
+	void _run(int n, int threadNum, void (*_task)(void*, int, int), void *arg);
+	void _work(int t, unsigned seen);
+	void _drain(int t);
+
+private:
+	std::vector<std::thread> workers; ///< thread t is workers[t-1].
+	std::mutex mutex;
+	std::condition_variable wake; ///< notified when a task is posted or the pool is stopping.
+	std::condition_variable idle; ///< notified when the last worker of the task is done.
+	void (*task)(void*, int, int); ///< the task being run, task(taskArg, t, k).
+	void *taskArg;
+	int taskN;
+	int taskThreads; ///< threads [0, taskThreads) work on the task, the others sit it out.
+	std::atomic<int> next; ///< the next k to hand out.
+	unsigned generation; ///< tasks posted so far, idle workers wait for it to change.
+	int pending; ///< workers not yet done with the task.
+	bool stopping;
+};
+
+#ifdef COUNT_ALLOCATIONS
+extern std::atomic<long> allocationCount; ///< calls of operator new, counted only when built with make DEFS=-DCOUNT_ALLOCATIONS.
+#endif
+
+/** read a text or binary case file into context, return the number of available UAVs. */
+int parseInput(const char *filename, ScenarioContext& context, int threadNum = 1);
+
+/** write context as a binary case file, see CaseFile.h. */
+void writeCase(const char *filename, const ScenarioContext& context, int availableUAVNum);
+
+/** whether the checksum of a binary case file matches its users and data rates, text case files always pass. */
+bool verifyCase(const char *filename);
 
 bool vectorFind(std::vector<int>& vec, const int key);
 
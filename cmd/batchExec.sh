@@ -5,9 +5,9 @@ if [ ! -x UAV ]; then
 	exit 1
 fi
 
-if [ $# -ne 1 ]; then
-	echo "Usage: $0 caseFileDir"
-	echo "Example: $0 ../cases/X2000Y2000N800K8"
+if [ $# -lt 1 -o $# -gt 2 ]; then
+	echo "Usage: $0 caseFileDir [jobs]"
+	echo "Example: $0 ../cases/X2000Y2000N800K8 8"
 	exit 1
 fi
 
@@ -16,19 +16,11 @@ if [ ! -d $1 ]; then
 	exit 1
 fi
 
-rm -f $1/statistic.csv
-
-for casefile in $1/case_*.txt; do
-	./UAV $casefile $1/statistic.csv > /dev/null
-	if [ $? -ne 0 ]; then
-		echo "error occurs when executing $casefile"
-		exit 1
-	fi
-	postfix=${casefile#$1/case}
-	prefix=${postfix%txt}
-	mv UAVs.csv $1/UAVs${prefix}csv
-	mv servedUsers.csv $1/servedUsers${prefix}csv
-done
+# UAV solves the cases in process, $2 of them at the same time
+./UAV --batch $1 -j ${2:-1} > /dev/null
+if [ $? -ne 0 ]; then
+	echo "error occurs when executing cases in $1"
+	exit 1
+fi
 
 echo "statistic.csv is generated in dir $1"
-
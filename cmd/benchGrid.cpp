@@ -0,0 +1,181 @@
+//
+// Copyright (C) 2017-2018 Xu Le <xmutongxinXuLe@163.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "Kernel.h"
+
+extern int log_level;
+
+#define GRANULARITY    50
+#define MAP_SIZE       4000
+
+static double _now()
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec/1000000.0;
+}
+
+/** users in lists per cell, as the buckets of Solution were before BucketGrid. */
+class ListGrid
+{
+public:
+	void initialize(int _xNum, int _yNum, const Point *_users, int userNum)
+	{
+		yNum = _yNum;
+		users = _users;
+		cells.assign(_xNum*yNum, std::list<int>());
+		for (int i = 0; i < userNum; ++i)
+			cells[_cell(i)].push_back(i);
+	}
+	void insert(int user) { cells[_cell(user)].push_back(user); }
+	void remove(int user)
+	{
+		std::list<int> &cell = cells[_cell(user)];
+		std::list<int>::iterator iter = std::find(cell.begin(), cell.end(), user);
+		assert(iter != cell.end());
+		cell.erase(iter);
+	}
+	int countInDisc(int mBegin, int mEnd, int nBegin, int nEnd, const Point& O, double R)
+	{
+		int count = 0;
+		for (int m = mBegin; m < mEnd; ++m)
+			for (int n = nBegin; n < nEnd; ++n)
+				for (std::list<int>::iterator iter = cells[m*yNum + n].begin(); iter != cells[m*yNum + n].end(); ++iter)
+					if (math::dist(users[*iter], O) < R)
+						++count;
+		return count;
+	}
+
+private:
+	int _cell(int user) { return static_cast<int>(users[user].x) / GRANULARITY * yNum + static_cast<int>(users[user].y) / GRANULARITY; }
+
+private:
+	int yNum;
+	const Point *users;
+	std::vector<std::list<int> > cells;
+};
+
+static int _countInDisc(BucketGrid& grid, int mBegin, int mEnd, int nBegin, int nEnd, const Point& O, double R)
+{
+	int count = 0;
+	for (int m = mBegin; m < mEnd; ++m)
+	{
+		int sBegin = grid.stripBegin(m, nBegin), sEnd = grid.stripEnd(m, nEnd);
+		count += kernel::countInDisc(grid.x.data() + sBegin, grid.y.data() + sBegin, sEnd - sBegin, O, R);
+	}
+	return count;
+}
+
+/**
+ * count users within R of random centers over the cells around them, with all users and with half of them removed,
+ * then remove and re-insert that half rounds times, with BucketGrid and with lists per cell, print the throughput
+ * of each and the speedup of BucketGrid.
+ */
+static void benchGrid(int n, double R, int queries, int updates, int rounds)
+{
+	srand(n);
+	std::vector<Point> users(n);
+	for (int i = 0; i < n; ++i)
+		users[i] = Point(rand() % (MAP_SIZE*100) / 100.0, rand() % (MAP_SIZE*100) / 100.0);
+	int cellNum = MAP_SIZE / GRANULARITY;
+	BucketGrid grid;
+	grid.initialize(cellNum, cellNum, GRANULARITY, users.data(), n);
+	ListGrid lists;
+	lists.initialize(cellNum, cellNum, users.data(), n);
+
+	std::vector<Point> centers(queries);
+	for (int q = 0; q < queries; ++q)
+		centers[q] = Point(rand() % MAP_SIZE, rand() % MAP_SIZE);
+	std::vector<int> picked(n); // the first updates of a random permutation of users
+	for (int i = 0; i < n; ++i)
+		picked[i] = i;
+	for (int u = 0; u < updates; ++u)
+		std::swap(picked[u], picked[u + rand() % (n - u)]);
+
+	double gridQuery = 0.0, listQuery = 0.0;
+	long gridSum = 0, listSum = 0;
+	for (int pass = 0; pass < 2; ++pass) // the second pass queries with half of the users removed
+	{
+		double start = _now();
+		for (int q = 0; q < queries; ++q)
+		{
+			const Point &O = centers[q];
+			int mBegin = std::max(static_cast<int>((O.x - R) / GRANULARITY), 0), mEnd = std::min(static_cast<int>((O.x + R) / GRANULARITY) + 1, cellNum);
+			int nBegin = std::max(static_cast<int>((O.y - R) / GRANULARITY), 0), nEnd = std::min(static_cast<int>((O.y + R) / GRANULARITY) + 1, cellNum);
+			gridSum += _countInDisc(grid, mBegin, mEnd, nBegin, nEnd, O, R);
+		}
+		gridQuery += _now() - start;
+		start = _now();
+		for (int q = 0; q < queries; ++q)
+		{
+			const Point &O = centers[q];
+			int mBegin = std::max(static_cast<int>((O.x - R) / GRANULARITY), 0), mEnd = std::min(static_cast<int>((O.x + R) / GRANULARITY) + 1, cellNum);
+			int nBegin = std::max(static_cast<int>((O.y - R) / GRANULARITY), 0), nEnd = std::min(static_cast<int>((O.y + R) / GRANULARITY) + 1, cellNum);
+			listSum += lists.countInDisc(mBegin, mEnd, nBegin, nEnd, O, R);
+		}
+		listQuery += _now() - start;
+
+		if (pass == 0)
+		{
+			for (int u = 0; u < updates; ++u)
+				grid.remove(picked[u]), lists.remove(picked[u]);
+		}
+	}
+	for (int u = 0; u < updates; ++u)
+		grid.insert(picked[u]), lists.insert(picked[u]);
+
+	// remove and re-insert the picked users rounds times
+	double start = _now();
+	for (int round = 0; round < rounds; ++round)
+	{
+		for (int u = 0; u < updates; ++u)
+			grid.remove(picked[u]);
+		for (int u = 0; u < updates; ++u)
+			grid.insert(picked[u]);
+	}
+	double gridUpdate = _now() - start;
+	start = _now();
+	for (int round = 0; round < rounds; ++round)
+	{
+		for (int u = 0; u < updates; ++u)
+			lists.remove(picked[u]);
+		for (int u = 0; u < updates; ++u)
+			lists.insert(picked[u]);
+	}
+	double listUpdate = _now() - start;
+	if (gridSum != listSum)
+	{
+		error_log("BucketGrid counts %ld users, but the lists count %ld.\n", gridSum, listSum);
+		exit(EXIT_FAILURE);
+	}
+	printf("n: %6d, R: %4.0f, query: %8.3f / %8.3f Mqueries/s (%5.1fx), update: %8.2f / %8.2f Mops (%5.1fx)\n", n, R,
+			2.0*queries/gridQuery/1e6, 2.0*queries/listQuery/1e6, listQuery/gridQuery,
+			2.0*updates*rounds/gridUpdate/1e6, 2.0*updates*rounds/listUpdate/1e6, listUpdate/gridUpdate);
+}
+
+int main()
+{
+	printf("BucketGrid / lists per cell, kernel path: %s\n", kernel::path());
+	int sizes[] = { 1000, 10000, 100000 };
+	double radii[] = { 200.0, 500.0 };
+	for (size_t k = 0; k < sizeof(sizes)/sizeof(sizes[0]); ++k)
+		for (size_t l = 0; l < sizeof(radii)/sizeof(radii[0]); ++l)
+			benchGrid(sizes[k], radii[l], 20000000 / sizes[k] + 100, sizes[k] / 2, 2000000 / sizes[k] + 1);
+
+	return 0;
+}
@@ -0,0 +1,92 @@
+//
+// Copyright (C) 2017-2018 Xu Le <xmutongxinXuLe@163.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "UAV.h"
+
+extern int log_level;
+
+static ScenarioContext context;
+
+static double _now()
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec/1000000.0;
+}
+
+/** serve, unserve and check n users of a single UAV for rounds times, print the throughput of each operation. */
+static void benchUAV(int n, int rounds)
+{
+	UAV uav(context, Band::_2_1);
+	uav.setH(UAV::maxH);
+	uav.setX(0.0), uav.setY(0.0);
+
+	std::vector<int> order(n);
+	for (int i = 0; i < n; ++i)
+		order[i] = i;
+	double serveTime = 0.0, unserveTime = 0.0, checkTime = 0.0;
+	std::vector<int> erased;
+	for (int round = 0; round < rounds; ++round)
+	{
+		std::random_shuffle(order.begin(), order.end());
+		uav.setX(0.0), uav.setY(0.0);
+		double start = _now();
+		for (int i = 0; i < n; ++i)
+			uav.serve(order[i]);
+		serveTime += _now() - start;
+		start = _now();
+		uav.check(erased); // nothing is out of range
+		checkTime += _now() - start;
+		start = _now();
+		for (int i = 0; i < n/2; ++i)
+			uav.unserve(order[i]);
+		unserveTime += _now() - start;
+		uav.setX(uav.getR()); // about half of the remaining users are out of range
+		start = _now();
+		uav.check(erased);
+		checkTime += _now() - start;
+		for (int i = n/2; i < n; ++i)
+			uav.unserve(order[i]);
+	}
+	printf("n: %5d, serve: %8.2f Mops, unserve: %8.2f Mops, check: %8.2f Musers/s\n", n,
+			static_cast<double>(n)*rounds/serveTime/1e6, static_cast<double>(n/2)*rounds/unserveTime/1e6, 1.5*n*rounds/checkTime/1e6);
+}
+
+int main()
+{
+	configureUAV();
+
+	context.numUser = 8000;
+	context.groundUsers = new Point[context.numUser];
+	context.servedTable.assign(context.numUser);
+	context.discSlot.assign(context.numUser, -1);
+	context.userSlot.assign(context.numUser, -1);
+	srand(1);
+	double R = UAV::radiusTable[UAV::maxH];
+	for (int i = 0; i < context.numUser; ++i)
+	{
+		double r = R * sqrt(static_cast<double>(rand()) / RAND_MAX), angle = 2*M_PI * rand() / RAND_MAX;
+		context.groundUsers[i] = Point(r*cos(angle), r*sin(angle));
+	}
+
+	int sizes[] = { 100, 500, 1000, 2000, 4000, 8000 };
+	for (size_t k = 0; k < sizeof(sizes)/sizeof(sizes[0]); ++k)
+		benchUAV(sizes[k], 8000000 / sizes[k] / 100 + 1);
+
+	return 0;
+}
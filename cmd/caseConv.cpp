@@ -0,0 +1,59 @@
+//
+// Copyright (C) 2017-2018 Xu Le <xmutongxinXuLe@163.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include <string.h>
+#include <string>
+#include "Utils.h"
+
+extern int log_level;
+
+static void printHelp()
+{
+	printf("Usage:\n    ./caseConv case_x.txt [case_x.bin]\n    ./caseConv -c case_x.bin\n");
+	printf("Options:\n    -c    verify the checksum of a binary case file\n");
+	printf("Example:\n    ./caseConv ../cases/X2000Y2000N800K8/case_1.txt\n");
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc == 3 && strcmp(argv[1], "-c") == 0)
+	{
+		bool valid = verifyCase(argv[2]);
+		uncond_log("%s: checksum %s\n", argv[2], valid ? "OK" : "mismatch");
+		return valid ? 0 : EXIT_FAILURE;
+	}
+	if (argc != 2 && argc != 3)
+	{
+		printHelp();
+		exit(EXIT_FAILURE);
+	}
+
+	// case_x.txt  ==>  case_x.bin by default
+	std::string binFile(argc == 3 ? argv[2] : argv[1]);
+	if (argc == 2)
+	{
+		size_t dot = binFile.rfind('.');
+		binFile = (dot != std::string::npos && binFile.find('/', dot) == std::string::npos ? binFile.substr(0, dot) : binFile) + ".bin";
+	}
+
+	ScenarioContext context;
+	int numAvailableUAV = parseInput(argv[1], context);
+	writeCase(binFile.c_str(), context, numAvailableUAV);
+	uncond_log("%s is generated\n", binFile.c_str());
+	return 0;
+}
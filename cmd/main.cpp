@@ -16,36 +16,119 @@
 // Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 //
 
-#include "IFDBSP.h"
+#include <unistd.h>
+#include <getopt.h>
+#include "Batch.h"
 
 extern int log_level;
 
-double gX = 0.0;
-double gY = 0.0;
-int numUser = 0;
-Point *groundUsers = NULL;
-double *rateTable = NULL;
-int *servedTable = NULL;
-
 static void printHelp()
 {
-	printf("Usage:\n    ./UAV case_x.txt\n");
-	printf("Example:\n    ./UAV case_1.txt\n");
+	printf("Usage:\n    ./UAV [-e engine] [-t threads] [-b blocks] [-a divisions] [-v] [-s seed] case_x.txt [statistic.csv]\n");
+	printf("    ./UAV --batch case_dir [-j jobs] [--stream] [-e engine] [-t threads] [-b blocks] [-a divisions] [-v] [-s seed]\n");
+	printf("Options:\n    -e    placement engine, 'brute' (default), 'sat', 'incr', 'lazy', 'tile', 'arc' or 'coarse', 'arc' is slow and only meant for small comparison cases\n");
+	printf("    -t    threads used by case file parsing, the brute force, tile and arc engines and UAV rotation, 1 by default\n");
+	printf("    -b    blocks of 8x8 candidate points refined by the coarse engine, 0 (default) refines every block that may hold the best point,\n          which is most of them, use 'sat' for exact placements\n");
+	printf("    -a    UAVs are rotated in steps of pi/divisions, 18 by default\n");
+	printf("    -s, --seed    seed of the random numbers used by UAV adjustment, 1 by default\n");
+	printf("    -v    verify the incrementally maintained deployment mask against full recomputation\n");
+	printf("    --batch    solve every case_x.txt of case_dir, write UAVs_x.csv, servedUsers_x.csv, statistic.csv and summary.csv to case_dir\n");
+	printf("    -j, --jobs    cases solved at the same time in batch mode, 1 by default\n");
+	printf("    --stream    rewrite summary.csv after every case in batch mode, not only at the end\n");
+	printf("Example:\n    ./UAV -e brute -t 8 case_1.txt\n    ./UAV --batch ../cases/X2000Y2000N800K8 -j 8\n");
 }
 
-static void deleteGlobal()
+static int parseEngine(const char *name)
 {
-	delete []groundUsers;
-	groundUsers = NULL;
-	delete []rateTable;
-	rateTable = NULL;
-	delete []servedTable;
-	servedTable = NULL;
+	if (strcmp(name, "brute") == 0)
+		return Solution::BRUTE_FORCE;
+	if (strcmp(name, "sat") == 0)
+		return Solution::SUMMED_AREA;
+	if (strcmp(name, "incr") == 0)
+		return Solution::INCREMENTAL;
+	if (strcmp(name, "lazy") == 0)
+		return Solution::LAZY_GREEDY;
+	if (strcmp(name, "tile") == 0)
+		return Solution::TILED;
+	if (strcmp(name, "arc") == 0)
+		return Solution::ARC_SWEEP;
+	if (strcmp(name, "coarse") == 0)
+		return Solution::COARSE_FINE;
+	error_log("Unknown placement engine %s.\n", name);
+	exit(EXIT_FAILURE);
 }
 
 int main(int argc, char *argv[])
 {
-	if (argc < 2 || argc > 3)
+	SolverOptions options;
+	const char *batchDir = NULL;
+	int jobNum = 1;
+	bool streamSummary = false;
+	const struct option longOptions[] = {
+		{ "seed", required_argument, NULL, 's' },
+		{ "batch", required_argument, NULL, 'B' },
+		{ "jobs", required_argument, NULL, 'j' },
+		{ "stream", no_argument, NULL, 'S' },
+		{ NULL, 0, NULL, 0 }
+	};
+	int opt = 0;
+	while ((opt = getopt_long(argc, argv, "e:t:b:a:vs:j:", longOptions, NULL)) != -1)
+	{
+		switch (opt)
+		{
+		case 'e':
+			options.engine = parseEngine(optarg);
+			break;
+		case 't':
+			options.threadNum = atoi(optarg);
+			if (options.threadNum < 1)
+			{
+				error_log("Thread number must be positive.\n");
+				exit(EXIT_FAILURE);
+			}
+			break;
+		case 'b':
+			options.coarseTopK = atoi(optarg);
+			if (options.coarseTopK < 0)
+			{
+				error_log("Block number must not be negative.\n");
+				exit(EXIT_FAILURE);
+			}
+			break;
+		case 'a':
+			options.alterDivisions = atoi(optarg);
+			if (options.alterDivisions < 1)
+			{
+				error_log("Angle divisions must be positive.\n");
+				exit(EXIT_FAILURE);
+			}
+			break;
+		case 'v':
+			options.verifyAllowed = true;
+			break;
+		case 's':
+			options.seed = strtoull(optarg, NULL, 10);
+			break;
+		case 'B':
+			batchDir = optarg;
+			break;
+		case 'S':
+			streamSummary = true;
+			break;
+		case 'j':
+			jobNum = atoi(optarg);
+			if (jobNum < 1)
+			{
+				error_log("Job number must be positive.\n");
+				exit(EXIT_FAILURE);
+			}
+			break;
+		default:
+			printHelp();
+			exit(EXIT_FAILURE);
+		}
+	}
+	if (batchDir != NULL ? argc - optind != 0 : (argc - optind < 1 || argc - optind > 2))
 	{
 		printHelp();
 		exit(EXIT_FAILURE);
@@ -53,15 +136,15 @@ int main(int argc, char *argv[])
 
 	printf("Current log level: %s\n\n", getLogLevel());
 
-	int numAvailableUAV = parseInput(argv[1]);
 	configureUAV();
-
+	if (batchDir != NULL)
 	{
-		Solution solution;
-		solution.deploy(numAvailableUAV, argc == 3 ? argv[2] : NULL);
-		solution.result("UAVs.csv", "servedUsers.csv");
+		runBatch(batchDir, jobNum, options, streamSummary);
+		return 0;
 	}
 
-	deleteGlobal();
+	DeployStatistic statistic;
+	solveCase(argv[optind], options, "UAVs.csv", "servedUsers.csv", argc - optind == 2 ? argv[optind+1] : NULL, statistic);
+
 	return 0;
 }
@@ -0,0 +1,130 @@
+//
+// Copyright (C) 2017-2018 Xu Le <xmutongxinXuLe@163.com>
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "Kernel.h"
+
+extern int log_level;
+
+static double _uniform(double lo, double hi)
+{
+	return lo + (hi - lo) * rand() / RAND_MAX;
+}
+
+/**
+ * n points around O: a quarter anywhere in the square of side 4R, a quarter near the circle, a quarter on it by
+ * angle, whose distances round to either side of R, and a quarter exactly on it, at the integer offsets of the
+ * Pythagorean triples scaled from R == 5*scale, which are out of the disc.
+ */
+static void _genPoints(std::vector<double>& x, std::vector<double>& y, int n, const Point& O, double R, int scale)
+{
+	static const int triples[][2] = { {3, 4}, {4, 3}, {5, 0}, {0, 5} };
+	x.resize(n), y.resize(n);
+	for (int k = 0; k < n; ++k)
+	{
+		double angle = _uniform(0.0, 2*M_PI), r = R;
+		switch (rand() % 4)
+		{
+		case 0:
+			x[k] = O.x + _uniform(-2*R, 2*R), y[k] = O.y + _uniform(-2*R, 2*R);
+			continue;
+		case 1:
+			r = R * (1 + _uniform(-1e-9, 1e-9));
+			break;
+		case 2:
+			break;
+		default:
+			const int *t = triples[rand() % 4];
+			x[k] = O.x + (rand() % 2 ? 1 : -1) * t[0]*scale, y[k] = O.y + (rand() % 2 ? 1 : -1) * t[1]*scale;
+			continue;
+		}
+		x[k] = O.x + r*cos(angle), y[k] = O.y + r*sin(angle);
+	}
+}
+
+static int _countScalar(const std::vector<double>& x, const std::vector<double>& y, int begin, int end, const Point& O, double R)
+{
+	int count = 0;
+	for (int k = begin; k < end; ++k)
+		if (math::dist(x[k], y[k], O) < R)
+			++count;
+	return count;
+}
+
+/** check every kernel against the math::dist loop on rounds random point sets, return the number of mismatches. */
+static int testKernel(int rounds)
+{
+	int failed = 0, onCircle = 0;
+	std::vector<double> x, y;
+	std::vector<int> selected, expected;
+	for (int round = 0; round < rounds; ++round)
+	{
+		int n = rand() % 70, scale = 1 + rand() % 200, centerNum = 1 + rand() % 8;
+		// integral centers keep the offsets of the triples exact
+		Point O(rand() % 8000 - 2000, rand() % 8000 - 2000);
+		double R = 5.0*scale;
+		_genPoints(x, y, n, O, R, scale);
+		// offsets into the arrays, so unaligned starts and tails of every length are taken
+		int begin = n > 0 ? rand() % std::min(n, 5) : 0;
+		const double *px = x.data() + begin, *py = y.data() + begin;
+		for (int k = begin; k < n; ++k)
+			onCircle += math::dist(x[k], y[k], O) == R ? 1 : 0;
+
+		int count = kernel::countInDisc(px, py, n - begin, O, R), expectedCount = _countScalar(x, y, begin, n, O, R);
+		if (count != expectedCount)
+		{
+			error_log("countInDisc: round %d, n %d, %d points are counted, but %d are expected.\n", round, n - begin, count, expectedCount);
+			++failed;
+		}
+
+		selected.assign(n + 1, -1);
+		int selectedNum = kernel::selectInDisc(px, py, n - begin, O, R, selected.data());
+		expected.clear();
+		for (int k = begin; k < n; ++k)
+			if (math::dist(x[k], y[k], O) < R)
+				expected.push_back(k - begin);
+		if (selectedNum != static_cast<int>(expected.size()) || !std::equal(expected.begin(), expected.end(), selected.begin()))
+		{
+			error_log("selectInDisc: round %d, n %d, %d points are selected, %lu are expected.\n", round, n - begin, selectedNum, expected.size());
+			++failed;
+		}
+
+		std::vector<Point> centers(centerNum, O);
+		std::vector<int> counts(centerNum), expectedCounts(centerNum);
+		for (int c = 1; c < centerNum; ++c)
+			centers[c] = Point(O.x + rand() % 3 * scale, O.y + rand() % 3 * scale);
+		for (int c = 0; c < centerNum; ++c)
+		{
+			counts[c] = c; // counts are added to
+			expectedCounts[c] = c + _countScalar(x, y, begin, n, centers[c], R);
+		}
+		kernel::countInDiscs(px, py, n - begin, centers.data(), centerNum, R, counts.data());
+		if (counts != expectedCounts)
+		{
+			error_log("countInDiscs: round %d, n %d, %d centers disagree with the scalar counts.\n", round, n - begin, centerNum);
+			++failed;
+		}
+	}
+	uncond_log("kernel path: %s, %d rounds, %d points exactly on the circle, %d mismatches\n", kernel::path(), rounds, onCircle, failed);
+	return failed;
+}
+
+int main()
+{
+	srand(1);
+	return testKernel(20000) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -18,9 +18,11 @@
 
 #include <cstring>
 #include <string>
+#include <vector>
 #include <algorithm>
 
 #include "Perlin.h"
+#include "../cmd/CaseFile.h"
 
 int gX = 0;
 int gY = 0;
@@ -174,9 +176,64 @@ static void fileOutput(const char *filename, Point *groundUsers, double *rateTab
 	fclose(fd);
 }
 
+/**
+ * write the binary case file of cmd/CaseFile.h, coordinates are rounded as in the text case file, so both solve alike.
+ * Unlike the text case file it carries the data rates, which is marked by CASE_RATES.
+ */
+static void binaryOutput(const char *filename, Point *groundUsers, double *rateTable)
+{
+	// written to a temporary file first and renamed, so no truncated case file is left behind
+	std::string tmpFile(filename);
+	tmpFile += ".tmp";
+	FILE *fd = fopen(tmpFile.c_str(), "wb");
+	if (fd == NULL)
+	{
+		fprintf(stderr, "Fail to open file %s.\n", tmpFile.c_str());
+		exit(EXIT_FAILURE);
+	}
+
+	CaseHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, CASE_MAGIC, 4);
+	header.version = CASE_VERSION;
+	header.recordSize = CASE_RECORD_SIZE;
+	header.gX = gX;
+	header.gY = gY;
+	header.numUser = numUser;
+	header.numAvailableUAV = numAvailableUAV;
+	header.flags = CASE_RATES;
+	std::vector<double> records(3*numUser, 0.0); // x, y, z of each user
+	char buf[64];
+	for (int i = 0; i < numUser; ++i)
+	{
+		snprintf(buf, sizeof(buf), "%f", groundUsers[i].x);
+		records[3*i] = strtod(buf, NULL);
+		snprintf(buf, sizeof(buf), "%f", groundUsers[i].y);
+		records[3*i+1] = strtod(buf, NULL);
+	}
+	header.checksum = caseChecksum(records.data(), records.size() * sizeof(double));
+	header.checksum = caseChecksum(rateTable, numUser * sizeof(double), header.checksum);
+
+	bool written = fwrite(&header, sizeof(header), 1, fd) == 1 && fwrite(records.data(), sizeof(double), records.size(), fd) == records.size() &&
+			fwrite(rateTable, sizeof(double), numUser, fd) == static_cast<size_t>(numUser);
+	if (fclose(fd) != 0 || !written)
+	{
+		remove(tmpFile.c_str());
+		fprintf(stderr, "Fail to write file %s.\n", tmpFile.c_str());
+		exit(EXIT_FAILURE);
+	}
+	if (rename(tmpFile.c_str(), filename) != 0)
+	{
+		remove(tmpFile.c_str());
+		fprintf(stderr, "Fail to rename %s to %s.\n", tmpFile.c_str(), filename);
+		exit(EXIT_FAILURE);
+	}
+}
+
 static void printHelp()
 {
 	printf("Usage:\n    ./genCases -x * -y * -n * -k * [-s *] case_x.txt\n");
+	printf("    a case file named case_x.bin is written in the binary format of cmd/CaseFile.h\n");
 	printf("Example:\n    ./genCases -x 4000 -y 4000 -n 1000 -k 10 [-s 1] case_1.txt\n");
 }
 
@@ -229,7 +286,10 @@ int main(int argc, char *argv[])
 	gufn[0] = 'u'; gufn[1] = 's'; gufn[2] = 'e'; gufn[3] = 'r';
 	gufn[gufnL-3] = 'c'; gufn[gufnL-2] = 's'; gufn[gufnL-1] = 'v';
 	drawGroundUsers(gufn.c_str(), groundUsers, rateTable);
-	fileOutput(argv[argc-1], groundUsers, rateTable);
+	if (strcmp(cfn + strlen(cfn) - 4, ".bin") == 0)
+		binaryOutput(cfn, groundUsers, rateTable);
+	else
+		fileOutput(cfn, groundUsers, rateTable);
 
 	delete []groundUsers;
 	delete []rateTable;